@@ -0,0 +1,135 @@
+#include "BatchVerifier.hpp"
+#include "Game.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+static mutex statsMtx;
+static BatchStats totals;
+
+// Shared with pool tasks, which may start after the caller has already returned
+struct BatchState
+{
+    vector<const Move *> moves;
+    atomic<size_t> next{0};
+    atomic<bool> failed{false};
+    mutex mtx;
+    condition_variable cv;
+    size_t finished = 0;     // Moves fully verified
+    size_t inFlight = 0;     // Threads between claiming a move and finishing it
+    unsigned int workers = 0;
+};
+
+static void drain(const shared_ptr<BatchState> &state)
+{
+    bool joined = false;
+    while (true)
+    {
+        // Registering before looking at failed means the caller, which waits for
+        // inFlight to reach zero after a failure, never returns under our feet
+        {
+            lock_guard<mutex> lock(state->mtx);
+            state->inFlight++;
+        }
+        size_t i = state->failed ? state->moves.size() : state->next.fetch_add(1);
+        bool claimed = i < state->moves.size();
+        bool valid = claimed && state->moves[i]->verifySignature();
+        if (valid)
+            SignatureCache::instance().insert(state->moves[i]->verificationDigest());
+        bool wake;
+        {
+            lock_guard<mutex> lock(state->mtx);
+            state->inFlight--;
+            if (claimed)
+            {
+                state->finished++;
+                if (!joined)
+                {
+                    state->workers++;
+                    joined = true;
+                }
+                if (!valid)
+                    state->failed = true;
+            }
+            wake = state->finished == state->moves.size() || (state->failed && state->inFlight == 0);
+        }
+        if (wake)
+            state->cv.notify_all();
+        if (!claimed || !valid)
+            return;
+    }
+}
+
+BatchVerifier::BatchVerifier(ThreadPool &pool) : pool(pool)
+{
+}
+
+BatchResult BatchVerifier::verify(const vector<const Move *> &moves)
+{
+    auto start = chrono::steady_clock::now();
+    BatchResult result;
+    result.total = moves.size();
+
+    auto state = make_shared<BatchState>();
+    for (const Move *move : moves)
+    {
+        if (SignatureCache::instance().contains(move->verificationDigest()))
+            result.cached++;
+        else
+            state->moves.push_back(move);
+    }
+
+    if (!state->moves.empty())
+    {
+        // The caller takes a share of the work, so one helper fewer than there are moves
+        size_t helpers = min<size_t>(pool.size(), state->moves.size() - 1);
+        for (size_t i = 0; i < helpers; i++)
+        {
+            pool.submit([state]
+                        { drain(state); });
+        }
+        drain(state);
+
+        unique_lock<mutex> lock(state->mtx);
+        state->cv.wait(lock, [&state]
+                       { return state->finished == state->moves.size() || (state->failed && state->inFlight == 0); });
+
+        result.valid = !state->failed;
+        result.checked = state->finished;
+        result.workers = state->workers;
+    }
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    lock_guard<mutex> lock(statsMtx);
+    totals.batches++;
+    totals.signatures += result.checked;
+    totals.totalSeconds += result.seconds;
+    totals.maxSeconds = max(totals.maxSeconds, result.seconds);
+    return result;
+}
+
+BatchResult BatchVerifier::verify(const Game &game)
+{
+    vector<BlockGame> chain = game.getChain();
+    vector<const Move *> moves;
+    for (const auto &block : chain)
+    {
+        for (const auto &move : block.moves)
+        {
+            moves.push_back(&move);
+        }
+    }
+    return verify(moves);
+}
+
+BatchStats BatchVerifier::stats()
+{
+    lock_guard<mutex> lock(statsMtx);
+    return totals;
+}
@@ -0,0 +1,51 @@
+#ifndef BATCHVERIFIER_HPP
+#define BATCHVERIFIER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Move.hpp"
+#include "ThreadPool.hpp"
+#include "SignatureCache.hpp"
+
+class Game;
+
+struct BatchResult
+{
+    bool valid = true;
+    size_t total = 0;       // Signatures in the batch
+    size_t checked = 0;     // Signatures actually verified before the batch finished
+    size_t cached = 0;      // Signatures skipped because SignatureCache already had them
+    unsigned int workers = 0; // Threads that took part, including the caller
+    double seconds = 0.0;
+};
+
+// Running totals across every batch, for sizing the pool
+struct BatchStats
+{
+    uint64_t batches = 0;
+    uint64_t signatures = 0;
+    double totalSeconds = 0.0;
+    double maxSeconds = 0.0;
+};
+
+// Checks many move signatures at once on a shared pool, skipping any already in
+// SignatureCache and adding the ones that pass. The calling thread works
+// through the batch alongside the pool, so a batch always makes progress even when
+// every pool thread is busy, and the first bad signature stops the rest.
+class BatchVerifier
+{
+private:
+    ThreadPool &pool;
+
+public:
+    explicit BatchVerifier(ThreadPool &pool = ThreadPool::shared());
+
+    BatchResult verify(const std::vector<const Move *> &moves);
+    // Every move in every block of the game
+    BatchResult verify(const Game &game);
+
+    static BatchStats stats();
+};
+
+#endif
@@ -1,47 +1,88 @@
 #include "BlockGame.hpp"
-#include <sstream>
-#include <iomanip>
-#include <openssl/sha.h>
+#include <ctime>
+#include <stdexcept>
 
-BlockGame::BlockGame(int idx, std::string prevHash, std::vector<Move> moves)
+BlockGame::BlockGame(int idx, const Hash256 &prevHash, std::vector<Move> moves)
 {
     this->index = idx;
     this->previousHash = prevHash;
     this->moves = moves;
     this->timestamp = time(nullptr);
     this->nonce = 0;
+    computeMerkleRoot();
     this->hash = calculateHash();
-    this->difficulty = 4; // Default difficulty
+    this->difficulty = 0; // Set to the required difficulty when mined
 }
 
-std::string BlockGame::calculateHash()
+Hash256 BlockGame::calculateHash()
 {
-    std::stringstream ss;
-    ss << index << previousHash << timestamp << nonce;
+    return calculateHash(nonce);
+}
+
+std::vector<Sha256::Digest> BlockGame::leafHashes() const
+{
+    std::vector<Sha256::Digest> leaves;
+    leaves.reserve(moves.size());
     for (const auto &tx : moves)
     {
-        ss << tx.toString();
+        leaves.push_back(Merkle::leafHash(tx.digest()));
     }
-    std::string input = ss.str();
+    return leaves;
+}
+
+void BlockGame::computeMerkleRoot()
+{
+    merkleRoot = Merkle::root(leafHashes());
+}
 
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256(reinterpret_cast<const unsigned char *>(input.c_str()), input.size(), hash);
+bool BlockGame::merkleRootMatches() const
+{
+    return Merkle::root(leafHashes()) == merkleRoot;
+}
 
-    std::stringstream hashString;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i)
+MerkleProof BlockGame::proveMove(int moveId) const
+{
+    for (size_t i = 0; i < moves.size(); i++)
     {
-        hashString << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+        if (moves[i].id == moveId)
+        {
+            return Merkle::prove(leafHashes(), i);
+        }
     }
+    throw std::runtime_error("Move " + std::to_string(moveId) + " is not in block " + std::to_string(index));
+}
 
-    return hashString.str();
+bool BlockGame::verifyMoveProof(const Move &move, const MerkleProof &proof, const BlockHeader &header)
+{
+    return Merkle::verify(Merkle::leafHash(move.digest()), proof, header.merkleRoot);
+}
+
+BlockHeader BlockGame::header(int nonce) const
+{
+    BlockHeader header;
+    header.index = index;
+    header.previousHash = previousHash;
+    header.timestamp = timestamp;
+    header.merkleRoot = merkleRoot;
+    header.nonce = nonce;
+    return header;
 }
 
-void BlockGame::mineBlock(int difficulty)
+Hash256 BlockGame::calculateHash(int nonce) const
 {
-    std::string target(difficulty, '0');
-    do
+    return header(nonce).hash();
+}
+
+MiningResult BlockGame::mineBlock(int difficulty, const MiningJob *job, unsigned int threads)
+{
+    this->difficulty = difficulty;
+    HeaderHasher hasher(header(nonce));
+    Miner miner(threads);
+    MiningResult result = miner.mine(hasher, difficulty, nonce + 1, job);
+    if (result.found)
     {
-        nonce++;
-        hash = calculateHash();
-    } while (hash.substr(0, difficulty) != target);
+        nonce = result.nonce;
+        hash = result.hash;
+    }
+    return result;
 }
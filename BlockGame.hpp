@@ -4,22 +4,35 @@
 #include <string>
 #include <vector>
 #include "Move.hpp"
+#include "Miner.hpp"
+#include "BlockHeader.hpp"
+#include "Merkle.hpp"
 
 class BlockGame
 {
 public:
     int index;
-    std::string previousHash;
+    Hash256 previousHash;
     std::vector<Move> moves;
     long timestamp;
     int nonce;
-    std::string hash;
-    int difficulty;
+    Hash256 hash;
+    int difficulty; // Leading zero bits of hash
+    Sha256::Digest merkleRoot; // Commits to moves; computed once per block template
 
-    BlockGame(int idx, std::string prevHash, std::vector<Move> moves);
+    BlockGame(int idx, const Hash256 &prevHash, std::vector<Move> moves);
 
-    std::string calculateHash();
-    void mineBlock(int difficulty);
+    std::vector<Sha256::Digest> leafHashes() const;
+    void computeMerkleRoot();
+    // False if merkleRoot no longer commits to the moves the block carries
+    bool merkleRootMatches() const;
+    BlockHeader header(int nonce) const;
+    Hash256 calculateHash();
+    Hash256 calculateHash(int nonce) const;
+    // Inclusion proof for one of this block's moves, checkable against the header alone
+    MerkleProof proveMove(int moveId) const;
+    static bool verifyMoveProof(const Move &move, const MerkleProof &proof, const BlockHeader &header);
+    MiningResult mineBlock(int difficulty, const MiningJob *job = nullptr, unsigned int threads = 0);
 };
 
 #endif
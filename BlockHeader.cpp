@@ -0,0 +1,72 @@
+#include "BlockHeader.hpp"
+#include <cstring>
+
+using namespace std;
+
+static void putUint32(unsigned char *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (unsigned char)(value >> (24 - 8 * i));
+    }
+}
+
+static void putUint64(unsigned char *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = (unsigned char)(value >> (56 - 8 * i));
+    }
+}
+
+array<unsigned char, BlockHeader::SIZE> BlockHeader::serialize() const
+{
+    array<unsigned char, SIZE> out;
+    putUint32(&out[0], index);
+    memcpy(&out[4], previousHash.data(), previousHash.size());
+    putUint64(&out[36], (uint64_t)timestamp);
+    memcpy(&out[44], merkleRoot.data(), merkleRoot.size());
+    putUint32(&out[NONCE_OFFSET], nonce);
+    return out;
+}
+
+Sha256::Digest BlockHeader::hash() const
+{
+    auto bytes = serialize();
+    return Sha256::hash(bytes.data(), bytes.size());
+}
+
+HeaderHasher::HeaderHasher(const BlockHeader &header)
+{
+    auto bytes = header.serialize();
+
+    Sha256 prefix;
+    prefix.update(bytes.data(), Sha256::BLOCK_SIZE);
+    midstate = prefix.midstate();
+
+    // Pre-pad the final block for an 80 byte (640 bit) message
+    tail.fill(0);
+    memcpy(tail.data(), bytes.data() + Sha256::BLOCK_SIZE, BlockHeader::SIZE - Sha256::BLOCK_SIZE);
+    tail[BlockHeader::SIZE - Sha256::BLOCK_SIZE] = 0x80;
+    putUint64(&tail[Sha256::BLOCK_SIZE - 8], BlockHeader::SIZE * 8);
+}
+
+Sha256::Digest HeaderHasher::hash(uint32_t nonce) const
+{
+    array<unsigned char, Sha256::BLOCK_SIZE> block = tail;
+    putUint32(&block[BlockHeader::NONCE_OFFSET - Sha256::BLOCK_SIZE], nonce);
+
+    Sha256::State state = midstate;
+    Sha256::compress(state, block.data());
+    return Sha256::digestFromState(state);
+}
+
+const Sha256::State &HeaderHasher::prefixState() const
+{
+    return midstate;
+}
+
+const array<unsigned char, Sha256::BLOCK_SIZE> &HeaderHasher::finalBlock() const
+{
+    return tail;
+}
@@ -0,0 +1,49 @@
+#ifndef BLOCKHEADER_HPP
+#define BLOCKHEADER_HPP
+
+#include <array>
+#include <cstdint>
+#include "Sha256.hpp"
+
+// Canonical 80 byte header hashed by both block types (all integers big-endian):
+//   [0, 4)   index
+//   [4, 36)  previous block hash
+//   [36, 44) timestamp
+//   [44, 76) Merkle root of the block body
+//   [76, 80) nonce
+class BlockHeader
+{
+public:
+    static const size_t SIZE = 80;
+    static const size_t NONCE_OFFSET = 76;
+
+    uint32_t index = 0;
+    Sha256::Digest previousHash{};
+    int64_t timestamp = 0;
+    Sha256::Digest merkleRoot{};
+    uint32_t nonce = 0;
+
+    std::array<unsigned char, SIZE> serialize() const;
+    Sha256::Digest hash() const;
+};
+
+// Per-block mining template: the first 64 header bytes never change while searching
+// nonces, so their compression state is computed once and every attempt costs a
+// single SHA-256 compression of the final block.
+class HeaderHasher
+{
+private:
+    Sha256::State midstate;
+    std::array<unsigned char, Sha256::BLOCK_SIZE> tail; // Header bytes [64, 80) plus SHA-256 padding
+
+public:
+    HeaderHasher(const BlockHeader &header);
+
+    Sha256::Digest hash(uint32_t nonce) const;
+
+    const Sha256::State &prefixState() const;
+    // Final message block with the nonce field left as zero
+    const std::array<unsigned char, Sha256::BLOCK_SIZE> &finalBlock() const;
+};
+
+#endif
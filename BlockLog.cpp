@@ -0,0 +1,449 @@
+#include "BlockLog.hpp"
+#include "Bytes.hpp"
+#include "ChainCodec.hpp"
+#include "DurableWriter.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+const string BlockLog::MAGIC = "CCBL";
+const string BlockLog::INDEX_MAGIC = "CCBI";
+
+static uint64_t fileSize(const string &path)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in.is_open())
+    {
+        return 0;
+    }
+    return (uint64_t)in.tellg();
+}
+
+static string fileHeader(const string &magic, uint32_t version)
+{
+    string header = magic;
+    appendUint32(header, version);
+    return header;
+}
+
+BlockIndexEntry BlockIndexEntry::of(const MainBlock &block, uint64_t offset, uint32_t length)
+{
+    BlockIndexEntry entry;
+    entry.offset = offset;
+    entry.length = length;
+    entry.index = block.index;
+    entry.timestamp = block.timestamp;
+    entry.nonce = block.nonce;
+    entry.difficulty = block.difficulty;
+    entry.gameCount = (uint32_t)block.games.size();
+    entry.previousHash = block.previousHash;
+    entry.merkleRoot = block.merkleRoot;
+    entry.hash = block.hash;
+    return entry;
+}
+
+BlockIndexEntry BlockIndexEntry::of(const MainBlockView &block, uint64_t offset, uint32_t length)
+{
+    BlockIndexEntry entry;
+    entry.offset = offset;
+    entry.length = length;
+    entry.index = block.index;
+    entry.timestamp = block.timestamp;
+    entry.nonce = block.nonce;
+    entry.difficulty = block.difficulty;
+    entry.gameCount = (uint32_t)block.gameCount();
+    entry.previousHash = block.previousHash;
+    entry.merkleRoot = block.merkleRoot();
+    entry.hash = block.hash;
+    return entry;
+}
+
+string BlockIndexEntry::encode() const
+{
+    string out;
+    out.reserve(SIZE);
+    appendUint64(out, offset);
+    appendUint32(out, length);
+    appendUint32(out, (uint32_t)index);
+    appendUint64(out, (uint64_t)timestamp);
+    appendUint32(out, (uint32_t)nonce);
+    appendUint32(out, (uint32_t)difficulty);
+    appendUint32(out, gameCount);
+    appendUint32(out, 0);
+    out.append(reinterpret_cast<const char *>(previousHash.data()), previousHash.size());
+    out.append(reinterpret_cast<const char *>(merkleRoot.data()), merkleRoot.size());
+    out.append(reinterpret_cast<const char *>(hash.data()), hash.size());
+    return out;
+}
+
+BlockIndexEntry BlockIndexEntry::decode(const unsigned char *bytes)
+{
+    BlockIndexEntry entry;
+    entry.offset = readUint64At(bytes);
+    entry.length = readUint32At(bytes + 8);
+    entry.index = (int)readUint32At(bytes + 12);
+    entry.timestamp = (long)readUint64At(bytes + 16);
+    entry.nonce = (int)readUint32At(bytes + 24);
+    entry.difficulty = (int)readUint32At(bytes + 28);
+    entry.gameCount = readUint32At(bytes + 32);
+    memcpy(entry.previousHash.data(), bytes + 40, 32);
+    memcpy(entry.merkleRoot.data(), bytes + 72, 32);
+    memcpy(entry.hash.data(), bytes + 104, 32);
+    return entry;
+}
+
+BlockHeader BlockIndexEntry::header() const
+{
+    BlockHeader header;
+    header.index = index;
+    header.previousHash = previousHash;
+    header.timestamp = timestamp;
+    header.merkleRoot = merkleRoot;
+    header.nonce = nonce;
+    return header;
+}
+
+BlockLog::BlockLog(const string &basePath) : logPath(basePath + ".log"), indexPath(basePath + ".idx")
+{
+    open();
+}
+
+void BlockLog::open()
+{
+    uint64_t logSize = fileSize(logPath);
+    if (logSize < HEADER_SIZE)
+    {
+        DurableWriter::instance().replace(logPath, fileHeader(MAGIC, VERSION), FileClass::Blockchain);
+        writeIndex({});
+        offsets.clear();
+        hashes.clear();
+        endOffset = HEADER_SIZE;
+    }
+    else
+    {
+        ifstream in(logPath, ios::binary);
+        string header(HEADER_SIZE, '\0');
+        in.read(&header[0], header.size());
+        if (header != fileHeader(MAGIC, VERSION))
+        {
+            throw runtime_error("Unrecognised block log " + logPath);
+        }
+        if (!indexMatchesLog(logSize))
+        {
+            rebuildIndex(logSize);
+        }
+    }
+    openForAppend();
+}
+
+bool BlockLog::indexMatchesLog(uint64_t logSize)
+{
+    ifstream index(indexPath, ios::binary);
+    if (!index.is_open())
+    {
+        return false;
+    }
+    string data((istreambuf_iterator<char>(index)), istreambuf_iterator<char>());
+    if (data.size() < HEADER_SIZE || data.compare(0, HEADER_SIZE, fileHeader(INDEX_MAGIC, INDEX_VERSION)) != 0 ||
+        (data.size() - HEADER_SIZE) % BlockIndexEntry::SIZE != 0)
+    {
+        return false;
+    }
+
+    offsets.clear();
+    hashes.clear();
+    BlockIndexEntry last;
+    uint64_t expected = HEADER_SIZE;
+    for (size_t pos = HEADER_SIZE; pos < data.size(); pos += BlockIndexEntry::SIZE)
+    {
+        last = BlockIndexEntry::decode(reinterpret_cast<const unsigned char *>(data.data()) + pos);
+        // Rows must tile the log exactly, one per height
+        if (last.offset != expected || last.index != (int)offsets.size() || last.offset >= logSize)
+        {
+            return false;
+        }
+        offsets.push_back(last.offset);
+        hashes.push_back(last.hash);
+        expected = last.offset + RECORD_HEADER_SIZE + last.length;
+    }
+    endOffset = expected;
+    if (offsets.empty())
+    {
+        return logSize == HEADER_SIZE;
+    }
+
+    // Only the newest record can have been cut short, so it is the only one read here
+    try
+    {
+        ifstream in(logPath, ios::binary);
+        // The hash check also catches an index left over from before reset() swapped the log
+        string payload = readRecord(in, last.offset);
+        if (payload.size() != last.length || RecordView(payload).mainBlock().hash != last.hash)
+        {
+            return false;
+        }
+    }
+    catch (const exception &)
+    {
+        return false;
+    }
+    return endOffset == logSize;
+}
+
+void BlockLog::rebuildIndex(uint64_t logSize)
+{
+    ifstream in(logPath, ios::binary);
+    offsets.clear();
+    hashes.clear();
+    vector<BlockIndexEntry> entries;
+    uint64_t offset = HEADER_SIZE;
+    while (offset < logSize)
+    {
+        try
+        {
+            // Checked in place; the index only needs header fields, not Game objects
+            string payload = readRecord(in, offset);
+            MainBlockView block = RecordView(payload).mainBlock();
+            if (block.index != (int)entries.size() || !block.verify())
+            {
+                break;
+            }
+            entries.push_back(BlockIndexEntry::of(block, offset, (uint32_t)payload.size()));
+            offsets.push_back(offset);
+            hashes.push_back(block.hash);
+            offset += RECORD_HEADER_SIZE + payload.size();
+        }
+        catch (const exception &)
+        {
+            break; // Torn or damaged tail; everything from here on is dropped
+        }
+    }
+    in.close();
+
+    endOffset = offset;
+    if (endOffset < logSize && truncate(logPath.c_str(), (off_t)endOffset) != 0)
+    {
+        throw runtime_error("Failed to truncate damaged tail of " + logPath);
+    }
+    writeIndex(entries);
+}
+
+void BlockLog::writeIndex(const vector<BlockIndexEntry> &entries)
+{
+    string data = fileHeader(INDEX_MAGIC, INDEX_VERSION);
+    for (const auto &entry : entries)
+    {
+        data += entry.encode();
+    }
+    DurableWriter::instance().replace(indexPath, data, FileClass::Blockchain);
+}
+
+void BlockLog::openForAppend()
+{
+    logOut.close();
+    indexOut.close();
+    logOut.clear();
+    indexOut.clear();
+    logOut.open(logPath, ios::binary | ios::app);
+    indexOut.open(indexPath, ios::binary | ios::app);
+    if (!logOut.is_open() || !indexOut.is_open())
+    {
+        throw runtime_error("Failed to open " + logPath + " for appending.");
+    }
+}
+
+string BlockLog::readRecord(ifstream &in, uint64_t offset) const
+{
+    in.clear();
+    in.seekg((streamoff)offset);
+    unsigned char header[RECORD_HEADER_SIZE];
+    if (!in.read(reinterpret_cast<char *>(header), sizeof(header)))
+    {
+        throw runtime_error("Truncated record header at offset " + to_string(offset));
+    }
+    uint32_t length = readUint32At(header);
+    uint32_t checksum = readUint32At(header + 4);
+
+    // A damaged length must not turn into a huge allocation
+    streamoff start = in.tellg();
+    in.seekg(0, ios::end);
+    if ((uint64_t)(in.tellg() - start) < length)
+    {
+        throw runtime_error("Truncated record at offset " + to_string(offset));
+    }
+    in.seekg(start);
+
+    string payload(length, '\0');
+    if (!in.read(&payload[0], length))
+    {
+        throw runtime_error("Truncated record at offset " + to_string(offset));
+    }
+    if (crc32(payload) != checksum)
+    {
+        throw runtime_error("Checksum mismatch at offset " + to_string(offset));
+    }
+    return payload;
+}
+
+static void appendRecord(string &out, const string &payload)
+{
+    appendUint32(out, (uint32_t)payload.size());
+    appendUint32(out, crc32(payload));
+    out.append(payload);
+}
+
+static string readPrefix(const string &path, uint64_t length)
+{
+    ifstream in(path, ios::binary);
+    string data(length, '\0');
+    if (!in.read(&data[0], (streamsize)length))
+    {
+        throw runtime_error("Failed to read " + path);
+    }
+    return data;
+}
+
+void BlockLog::appendBlocks(const vector<const MainBlock *> &blocks, const vector<string> &payloads)
+{
+    string records;
+    string rows;
+    vector<uint64_t> added;
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if ((size_t)blocks[i]->index != offsets.size() + i)
+        {
+            throw runtime_error("Block " + to_string(blocks[i]->index) + " is not the next height of " + logPath +
+                                " (" + to_string(offsets.size() + i) + ")");
+        }
+        uint64_t offset = endOffset + records.size();
+        rows += BlockIndexEntry::of(*blocks[i], offset, (uint32_t)payloads[i].size()).encode();
+        appendRecord(records, payloads[i]);
+        added.push_back(offset);
+    }
+    if (blocks.empty())
+    {
+        return;
+    }
+
+    // Log first: an index row never points past the end of the log
+    logOut.write(records.data(), records.size());
+    logOut.flush();
+    indexOut.write(rows.data(), rows.size());
+    indexOut.flush();
+    if (!logOut || !indexOut)
+    {
+        throw runtime_error("Failed to append block " + to_string(blocks.back()->index) + " to " + logPath);
+    }
+    DurableWriter::instance().commit(logPath, FileClass::Blockchain);
+    DurableWriter::instance().commit(indexPath, FileClass::Blockchain);
+
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        offsets.push_back(added[i]);
+        hashes.push_back(blocks[i]->hash);
+    }
+    endOffset += records.size();
+}
+
+void BlockLog::append(const MainBlock &block)
+{
+    string payload = ChainCodec::encode(block);
+    lock_guard<mutex> lock(mtx);
+    appendBlocks({&block}, {payload});
+}
+
+void BlockLog::reset(const vector<MainBlock> &chain)
+{
+    lock_guard<mutex> lock(mtx);
+    size_t keep = 0;
+    while (keep < hashes.size() && keep < chain.size() && hashes[keep] == chain[keep].hash)
+    {
+        keep++;
+    }
+
+    vector<const MainBlock *> blocks;
+    vector<string> payloads;
+    for (size_t height = keep; height < chain.size(); height++)
+    {
+        blocks.push_back(&chain[height]);
+        payloads.push_back(ChainCodec::encode(chain[height]));
+    }
+    if (keep == offsets.size())
+    {
+        appendBlocks(blocks, payloads);
+        return;
+    }
+
+    // The chains diverge inside the log: copy the common prefix, add the new blocks and
+    // install both files whole
+    uint64_t prefixEnd = offsets[keep];
+    string log = readPrefix(logPath, prefixEnd);
+    string index = readPrefix(indexPath, HEADER_SIZE + keep * BlockIndexEntry::SIZE);
+    offsets.resize(keep);
+    hashes.resize(keep);
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if ((size_t)blocks[i]->index != keep + i)
+        {
+            throw runtime_error("Block " + to_string(blocks[i]->index) + " is out of order for " + logPath);
+        }
+        uint64_t offset = log.size();
+        index += BlockIndexEntry::of(*blocks[i], offset, (uint32_t)payloads[i].size()).encode();
+        appendRecord(log, payloads[i]);
+        offsets.push_back(offset);
+        hashes.push_back(blocks[i]->hash);
+    }
+
+    logOut.close();
+    indexOut.close();
+    // Log first: if the index is left stale by a crash here, open() sees it does not tile the log and rebuilds it
+    DurableWriter::instance().replace(logPath, log, FileClass::Blockchain);
+    DurableWriter::instance().replace(indexPath, index, FileClass::Blockchain);
+    endOffset = log.size();
+    openForAppend();
+}
+
+size_t BlockLog::size() const
+{
+    lock_guard<mutex> lock(mtx);
+    return offsets.size();
+}
+
+MainBlock BlockLog::read(size_t height) const
+{
+    uint64_t offset;
+    {
+        lock_guard<mutex> lock(mtx);
+        if (height >= offsets.size())
+        {
+            throw out_of_range("No block at height " + to_string(height) + " in " + logPath);
+        }
+        offset = offsets[height];
+    }
+    ifstream in(logPath, ios::binary);
+    return ChainCodec::decode(readRecord(in, offset));
+}
+
+vector<MainBlock> BlockLog::readAll() const
+{
+    vector<uint64_t> snapshot;
+    {
+        lock_guard<mutex> lock(mtx);
+        snapshot = offsets;
+    }
+    ifstream in(logPath, ios::binary);
+    vector<MainBlock> chain;
+    chain.reserve(snapshot.size());
+    for (uint64_t offset : snapshot)
+    {
+        chain.push_back(ChainCodec::decode(readRecord(in, offset)));
+    }
+    return chain;
+}
+
+const string &BlockLog::getPath() const
+{
+    return logPath;
+}
@@ -0,0 +1,88 @@
+#ifndef BLOCKLOG_HPP
+#define BLOCKLOG_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MainBlock.hpp"
+#include "BlockHeader.hpp"
+#include "RecordView.hpp"
+
+// One fixed-width row of <base>.idx: where block n's record is, plus its header fields,
+// so headers can be listed without reading the log
+struct BlockIndexEntry
+{
+    static const size_t SIZE = 136;
+
+    uint64_t offset = 0; // Record start in <base>.log
+    uint32_t length = 0; // Payload bytes
+    int index = 0;
+    long timestamp = 0;
+    int nonce = 0;
+    int difficulty = 0;
+    uint32_t gameCount = 0;
+    Hash256 previousHash{};
+    Sha256::Digest merkleRoot{};
+    Hash256 hash{};
+
+    static BlockIndexEntry of(const MainBlock &block, uint64_t offset, uint32_t length);
+    static BlockIndexEntry of(const MainBlockView &block, uint64_t offset, uint32_t length);
+    // Big-endian; 4 reserved zero bytes keep the hashes 8-byte aligned
+    std::string encode() const;
+    static BlockIndexEntry decode(const unsigned char *bytes);
+    BlockHeader header() const;
+};
+
+// Append-only main chain storage. <base>.log is a magic/version header followed by one
+// record per block: u32 payload length, u32 CRC-32 of the payload, then the ChainCodec
+// payload. <base>.idx is a magic/version header followed by one BlockIndexEntry per
+// height, so block n and its header are one seek away (see ChainStore for readers).
+// Opening checks the last indexed record; if it is missing or damaged the log is scanned,
+// a torn tail from an interrupted append is cut off and the index is rebuilt.
+class BlockLog
+{
+private:
+    std::string logPath;
+    std::string indexPath;
+    mutable std::mutex mtx;
+    std::vector<uint64_t> offsets; // Record offset per height
+    std::vector<Hash256> hashes;   // Block hash per height, to find what reset() can keep
+    uint64_t endOffset = 0;        // Where the next record goes
+    std::ofstream logOut;
+    std::ofstream indexOut;
+
+    void open();
+    bool indexMatchesLog(uint64_t logSize);
+    void rebuildIndex(uint64_t logSize);
+    void writeIndex(const std::vector<BlockIndexEntry> &entries);
+    void openForAppend();
+    std::string readRecord(std::ifstream &in, uint64_t offset) const;
+    // Writes blocks that follow the tip with one write and one commit per file; caller holds mtx
+    void appendBlocks(const std::vector<const MainBlock *> &blocks, const std::vector<std::string> &payloads);
+
+public:
+    static const std::string MAGIC;       // "CCBL"
+    static const std::string INDEX_MAGIC; // "CCBI"
+    static const uint32_t VERSION = 3;
+    static const uint32_t INDEX_VERSION = 1;
+    static const uint64_t HEADER_SIZE = 8;        // Magic and version, in both files
+    static const uint64_t RECORD_HEADER_SIZE = 8; // Length and checksum
+
+    explicit BlockLog(const std::string &basePath);
+
+    // Writes one record and one index entry; the block must be the next height
+    void append(const MainBlock &block);
+    // Makes the log hold `chain`, used when the node adopts a different one. The prefix
+    // already on disk is kept; if the log only lacks the newest blocks they are appended,
+    // otherwise new log and index files are built and swapped in with DurableWriter::replace,
+    // so a crash leaves either the old chain or the new one.
+    void reset(const std::vector<MainBlock> &chain);
+    size_t size() const;
+    MainBlock read(size_t height) const;
+    std::vector<MainBlock> readAll() const;
+    const std::string &getPath() const;
+};
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef BYTES_HPP
+#define BYTES_HPP
+
+#include "Hash256.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Big-endian helpers for building canonical byte encodings
+
+inline void appendUint8(std::string &out, uint8_t value)
+{
+    out.push_back((char)value);
+}
+
+inline void appendUint16(std::string &out, uint16_t value)
+{
+    out.push_back((char)(value >> 8));
+    out.push_back((char)value);
+}
+
+inline void appendUint32(std::string &out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        out.push_back((char)(value >> shift));
+    }
+}
+
+inline void appendUint64(std::string &out, uint64_t value)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+    {
+        out.push_back((char)(value >> shift));
+    }
+}
+
+// Length-prefixed so adjacent fields can never run into each other
+inline void appendString(std::string &out, const std::string &value)
+{
+    appendUint32(out, (uint32_t)value.size());
+    out.append(value);
+}
+
+// Hashes and addresses are fixed-width, so no length prefix
+inline void appendHash(std::string &out, const Hash256 &hash)
+{
+    out.append(reinterpret_cast<const char *>(hash.data()), hash.size());
+}
+
+// Reflected CRC-32 (IEEE 802.3), the same checksum zlib and PNG use; guards on-disk records
+inline uint32_t crc32(const void *data, size_t length)
+{
+    static const std::array<uint32_t, 256> table = []
+    {
+        std::array<uint32_t, 256> t;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+inline uint32_t crc32(const std::string &data)
+{
+    return crc32(data.data(), data.size());
+}
+
+// Raw reads for fixed-width fields in mapped or already bounds-checked buffers
+inline uint32_t readUint32At(const unsigned char *data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value = value << 8 | data[i];
+    }
+    return value;
+}
+
+inline uint64_t readUint64At(const unsigned char *data)
+{
+    return (uint64_t)readUint32At(data) << 32 | readUint32At(data + 4);
+}
+
+// Reads back what the append helpers wrote; throws runtime_error on truncated input.
+// Only a view is held, so the bytes must outlive the reader.
+class ByteReader
+{
+private:
+    std::string_view data;
+    size_t pos = 0;
+
+    void need(size_t bytes)
+    {
+        if (data.size() - pos < bytes)
+        {
+            throw std::runtime_error("Truncated record");
+        }
+    }
+
+public:
+    explicit ByteReader(std::string_view data) : data(data) {}
+
+    uint8_t readUint8()
+    {
+        need(1);
+        return (uint8_t)data[pos++];
+    }
+
+    uint16_t readUint16()
+    {
+        need(2);
+        uint16_t value = (uint16_t)((uint8_t)data[pos] << 8 | (uint8_t)data[pos + 1]);
+        pos += 2;
+        return value;
+    }
+
+    uint32_t readUint32()
+    {
+        need(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            value = value << 8 | (uint8_t)data[pos++];
+        }
+        return value;
+    }
+
+    uint64_t readUint64()
+    {
+        need(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            value = value << 8 | (uint8_t)data[pos++];
+        }
+        return value;
+    }
+
+    // Points into the underlying bytes instead of copying them
+    std::string_view readView(size_t length)
+    {
+        need(length);
+        std::string_view out = data.substr(pos, length);
+        pos += length;
+        return out;
+    }
+
+    std::string_view readStringView()
+    {
+        return readView(readUint32());
+    }
+
+    std::string readBytes(size_t length)
+    {
+        return std::string(readView(length));
+    }
+
+    std::string readString()
+    {
+        return readBytes(readUint32());
+    }
+
+    // An entry count, rejected when the bytes left could not hold that many entries of at
+    // least minEntrySize each, so a corrupt count can't drive a huge reserve()
+    uint32_t readCount(size_t minEntrySize)
+    {
+        uint32_t count = readUint32();
+        if (count > remaining() / minEntrySize)
+        {
+            throw std::runtime_error("Record count " + std::to_string(count) + " exceeds the bytes left");
+        }
+        return count;
+    }
+
+    void skip(size_t length)
+    {
+        need(length);
+        pos += length;
+    }
+
+    size_t remaining() const
+    {
+        return data.size() - pos;
+    }
+
+    size_t position() const
+    {
+        return pos;
+    }
+
+    bool done() const
+    {
+        return pos == data.size();
+    }
+};
+
+inline Hash256 readHash(ByteReader &reader)
+{
+    Hash256 hash;
+    std::string_view bytes = reader.readView(hash.size());
+    memcpy(hash.data(), bytes.data(), hash.size());
+    return hash;
+}
+
+#endif
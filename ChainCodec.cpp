@@ -0,0 +1,251 @@
+#include "ChainCodec.hpp"
+#include "Bytes.hpp"
+#include <stdexcept>
+
+using namespace std;
+
+static void appendRecordHeader(string &out, RecordType type)
+{
+    appendUint8(out, (uint8_t)type);
+    appendUint8(out, ChainCodec::FORMAT_VERSION);
+}
+
+static void readRecordHeader(ByteReader &reader, RecordType type)
+{
+    uint8_t actual = reader.readUint8();
+    if (actual != (uint8_t)type)
+    {
+        throw runtime_error("Expected record type " + to_string((int)type) + ", found " + to_string((int)actual));
+    }
+    uint8_t version = reader.readUint8();
+    if (version != ChainCodec::FORMAT_VERSION)
+    {
+        throw runtime_error("Unsupported record format version " + to_string((int)version));
+    }
+}
+
+static void expectDone(const ByteReader &reader, const string &what)
+{
+    if (!reader.done())
+    {
+        throw runtime_error("Trailing bytes after " + what);
+    }
+}
+
+static Move readMove(ByteReader &reader)
+{
+    uint32_t id = reader.readUint32();
+    SignatureAlgorithm scheme = (SignatureAlgorithm)reader.readUint8();
+    if (!SignatureScheme::isKnown(scheme))
+    {
+        throw runtime_error("Unknown signature scheme " + to_string((int)scheme));
+    }
+    Address sender = readHash(reader);
+    Address receiver = readHash(reader);
+    Move move(sender, receiver, ChessMove::fromPacked(reader.readUint16()));
+    move.id = (int)id;
+    move.scheme = scheme;
+    move.signature = reader.readString();
+    move.seal();
+    return move;
+}
+
+static void appendGameBlock(string &out, const BlockGame &block)
+{
+    appendUint32(out, (uint32_t)block.index);
+    appendHash(out, block.previousHash);
+    appendUint64(out, (uint64_t)block.timestamp);
+    appendUint32(out, (uint32_t)block.nonce);
+    appendUint32(out, (uint32_t)block.difficulty);
+    appendHash(out, block.hash);
+    appendUint32(out, (uint32_t)block.moves.size());
+    for (const auto &move : block.moves)
+    {
+        appendString(out, move.canonicalBytes());
+    }
+}
+
+static BlockGame readGameBlock(ByteReader &reader)
+{
+    int index = (int)reader.readUint32();
+    Hash256 previousHash = readHash(reader);
+    long timestamp = (long)reader.readUint64();
+    int nonce = (int)reader.readUint32();
+    int difficulty = (int)reader.readUint32();
+    Hash256 hash = readHash(reader);
+
+    uint32_t count = reader.readCount(4); // Length-prefixed bodies
+    vector<Move> moves;
+    moves.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        string bytes = reader.readString();
+        ByteReader moveReader(bytes);
+        moves.push_back(readMove(moveReader));
+        expectDone(moveReader, "move " + to_string(moves.back().id));
+    }
+
+    BlockGame block(index, previousHash, moves);
+    block.timestamp = timestamp;
+    block.nonce = nonce;
+    block.difficulty = difficulty;
+    block.hash = hash;
+    if (!block.merkleRootMatches() || block.calculateHash(nonce) != hash)
+    {
+        throw runtime_error("Game block " + to_string(index) + " does not match its hash");
+    }
+    return block;
+}
+
+static void appendGame(string &out, const Game &game)
+{
+    appendUint32(out, (uint32_t)game.gameId);
+    appendUint32(out, (uint32_t)game.players.size());
+    for (const auto &player : game.players)
+    {
+        appendHash(out, player);
+    }
+    appendHash(out, game.winnerId);
+    appendUint8(out, game.gameComplete ? 1 : 0);
+
+    vector<BlockGame> chain = game.getChain();
+    appendUint32(out, (uint32_t)chain.size());
+    for (const auto &block : chain)
+    {
+        string body;
+        appendGameBlock(body, block);
+        appendString(out, body);
+    }
+}
+
+static Game readGame(ByteReader &reader)
+{
+    int gameId = (int)reader.readUint32();
+    uint32_t playerCount = reader.readCount(Address().size());
+    vector<Address> players;
+    players.reserve(playerCount);
+    for (uint32_t i = 0; i < playerCount; i++)
+    {
+        players.push_back(readHash(reader));
+    }
+    Address winnerId = readHash(reader);
+    bool gameComplete = reader.readUint8() != 0;
+
+    uint32_t blockCount = reader.readCount(4);
+    vector<BlockGame> chain;
+    chain.reserve(blockCount);
+    for (uint32_t i = 0; i < blockCount; i++)
+    {
+        string body = reader.readString();
+        ByteReader blockReader(body);
+        chain.push_back(readGameBlock(blockReader));
+        expectDone(blockReader, "game block " + to_string(chain.back().index));
+    }
+    return Game(gameId, players, winnerId, gameComplete, chain);
+}
+
+string ChainCodec::encode(const MainBlock &block)
+{
+    string out;
+    appendRecordHeader(out, RecordType::MainBlock);
+    appendUint32(out, (uint32_t)block.index);
+    appendHash(out, block.previousHash);
+    appendUint64(out, (uint64_t)block.timestamp);
+    appendUint32(out, (uint32_t)block.nonce);
+    appendUint32(out, (uint32_t)block.difficulty);
+    appendHash(out, block.hash);
+    appendUint32(out, (uint32_t)block.games.size());
+    for (const auto &game : block.games)
+    {
+        string body;
+        appendGame(body, game);
+        appendString(out, body);
+    }
+    return out;
+}
+
+MainBlock ChainCodec::decode(const string &bytes)
+{
+    ByteReader reader(bytes);
+    readRecordHeader(reader, RecordType::MainBlock);
+    int index = (int)reader.readUint32();
+    Hash256 previousHash = readHash(reader);
+    long timestamp = (long)reader.readUint64();
+    int nonce = (int)reader.readUint32();
+    int difficulty = (int)reader.readUint32();
+    Hash256 hash = readHash(reader);
+
+    uint32_t count = reader.readCount(4);
+    vector<Game> games;
+    games.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        string body = reader.readString();
+        ByteReader gameReader(body);
+        games.push_back(readGame(gameReader));
+        expectDone(gameReader, "game " + to_string(games.back().gameId));
+    }
+    expectDone(reader, "block " + to_string(index));
+
+    MainBlock block(index, previousHash, games);
+    block.timestamp = timestamp;
+    block.nonce = nonce;
+    block.difficulty = difficulty;
+    block.hash = hash;
+    if (!block.merkleRootMatches() || block.calculateHash(nonce) != hash)
+    {
+        throw runtime_error("Block " + to_string(index) + " does not match its hash");
+    }
+    return block;
+}
+
+string ChainCodec::encodeGame(const Game &game)
+{
+    string out;
+    appendRecordHeader(out, RecordType::Game);
+    appendGame(out, game);
+    return out;
+}
+
+Game ChainCodec::decodeGame(const string &bytes)
+{
+    ByteReader reader(bytes);
+    readRecordHeader(reader, RecordType::Game);
+    Game game = readGame(reader);
+    expectDone(reader, "game " + to_string(game.gameId));
+    return game;
+}
+
+string ChainCodec::encodeBlockGame(const BlockGame &block)
+{
+    string out;
+    appendRecordHeader(out, RecordType::GameBlock);
+    appendGameBlock(out, block);
+    return out;
+}
+
+BlockGame ChainCodec::decodeBlockGame(const string &bytes)
+{
+    ByteReader reader(bytes);
+    readRecordHeader(reader, RecordType::GameBlock);
+    BlockGame block = readGameBlock(reader);
+    expectDone(reader, "game block " + to_string(block.index));
+    return block;
+}
+
+string ChainCodec::encodeMove(const Move &move)
+{
+    string out;
+    appendRecordHeader(out, RecordType::Move);
+    out += move.canonicalBytes();
+    return out;
+}
+
+Move ChainCodec::decodeMove(const string &bytes)
+{
+    ByteReader reader(bytes);
+    readRecordHeader(reader, RecordType::Move);
+    Move move = readMove(reader);
+    expectDone(reader, "move " + to_string(move.id));
+    return move;
+}
@@ -0,0 +1,38 @@
+#ifndef CHAINCODEC_HPP
+#define CHAINCODEC_HPP
+
+#include <string>
+#include "MainBlock.hpp"
+
+enum class RecordType : uint8_t
+{
+    Move = 1,
+    GameBlock = 2,
+    Game = 3,
+    MainBlock = 4
+};
+
+// Binary encoding of moves, game blocks, games and main chain blocks. A record starts
+// with a one byte RecordType and a one byte format version; the body that follows nests
+// its children as length-prefixed bodies without a header of their own, so a reader can
+// step over any of them (see RecordView). Integers are big-endian (see Bytes.hpp) and a
+// move body is its canonical bytes. Decoding rejects an unknown type or version,
+// recomputes every block hash from its header and throws runtime_error on a mismatch.
+class ChainCodec
+{
+public:
+    static const uint8_t FORMAT_VERSION = 1;
+    static const size_t RECORD_HEADER_SIZE = 2;
+
+    static std::string encode(const MainBlock &block);
+    static MainBlock decode(const std::string &bytes);
+
+    static std::string encodeGame(const Game &game);
+    static Game decodeGame(const std::string &bytes);
+    static std::string encodeBlockGame(const BlockGame &block);
+    static BlockGame decodeBlockGame(const std::string &bytes);
+    static std::string encodeMove(const Move &move);
+    static Move decodeMove(const std::string &bytes);
+};
+
+#endif
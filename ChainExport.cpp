@@ -0,0 +1,332 @@
+#include "ChainExport.hpp"
+#include "ChainStore.hpp"
+#include "ChainCodec.hpp"
+#include "MempoolJournal.hpp"
+#include "RecordView.hpp"
+#include "Bytes.hpp"
+#include "MoveJournal.hpp"
+#include <dirent.h>
+#include <queue>
+#include <tuple>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+using json = nlohmann::json;
+
+static bool endsWith(const string &value, const string &suffix)
+{
+    return value.size() > suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static string stripSuffix(string path, const vector<string> &suffixes)
+{
+    for (const auto &suffix : suffixes)
+    {
+        if (endsWith(path, suffix))
+        {
+            path.erase(path.size() - suffix.size());
+            break;
+        }
+    }
+    return path;
+}
+
+static json addressesJson(const vector<Address> &addresses)
+{
+    json out = json::array();
+    for (const auto &address : addresses)
+    {
+        out.push_back(address.toHex());
+    }
+    return out;
+}
+
+static string hexOf(string_view bytes)
+{
+    static const char digits[] = "0123456789abcdef";
+    string hex;
+    hex.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes)
+    {
+        hex.push_back(digits[c >> 4]);
+        hex.push_back(digits[c & 0xF]);
+    }
+    return hex;
+}
+
+static string schemeName(SignatureAlgorithm algorithm)
+{
+    try
+    {
+        return SignatureScheme::get(algorithm).name();
+    }
+    catch (const exception &)
+    {
+        return "unknown";
+    }
+}
+
+// Read straight from the record bytes; signatures and the game id are kept so the JSON
+// holds everything the binary file does
+static json gameBlocksJson(const GameView &game)
+{
+    json blocks = json::array();
+    for (size_t i = 0; i < game.blockCount(); i++)
+    {
+        GameBlockView block = game.block(i);
+        json blockJson = {
+            {"gameId", game.gameId},
+            {"index", block.index},
+            {"previousHash", block.previousHash.toHex()},
+            {"hash", block.hash.toHex()},
+            {"timestamp", block.timestamp},
+            {"difficulty", block.difficulty},
+            {"moves", json::array()},
+            {"nonce", block.nonce},
+            {"valid", block.verify()}};
+        for (size_t m = 0; m < block.moveCount(); m++)
+        {
+            MoveView move = block.move(m);
+            blockJson["moves"].push_back({{"id", move.id()},
+                                          {"sender", move.sender().toHex()},
+                                          {"receiver", move.receiver().toHex()},
+                                          {"move", move.chessMove().toUci()},
+                                          {"scheme", schemeName(move.scheme())},
+                                          {"signature", hexOf(move.signature())},
+                                          {"digest", move.digest().toHex()}});
+        }
+        blocks.push_back(blockJson);
+    }
+    return blocks;
+}
+
+static int writeJson(const json &value, const string &outPath)
+{
+    ofstream outFile(outPath, ios::trunc);
+    if (!outFile.is_open())
+    {
+        cerr << "Error: failed to open " << outPath << " for writing.\n";
+        return 1;
+    }
+    outFile << value.dump(4); // Pretty print with 4 spaces
+    cout << "Exported " << value.size() << " entries to " << outPath << endl;
+    return 0;
+}
+
+int ChainExport::exportChain(string basePath, string outPath)
+{
+    basePath = stripSuffix(basePath, {".log", ".idx"});
+    if (outPath.empty())
+    {
+        outPath = basePath + ".json";
+    }
+    if (!ifstream(basePath + ".log").is_open())
+    {
+        cerr << "Error: no block log at " << basePath << ".log\n";
+        return 1;
+    }
+
+    json blockchainJson = json::array();
+    try
+    {
+        // Read through the mapped store, so exporting never touches the files
+        ChainStore store(basePath);
+        for (size_t height = 0; height < store.size(); height++)
+        {
+            MainBlock block = store.block(height);
+            json blockJson = {
+                {"index", block.index},
+                {"previousHash", block.previousHash.toHex()},
+                {"hash", block.hash.toHex()},
+                {"timestamp", block.timestamp},
+                {"games", json::array()},
+                {"nonce", block.nonce}};
+            for (const auto &txn : block.games)
+            {
+                blockJson["games"].push_back(txn.toString());
+            }
+            blockchainJson.push_back(blockJson);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return writeJson(blockchainJson, outPath);
+}
+
+int ChainExport::exportMempool(string basePath, string outPath)
+{
+    basePath = stripSuffix(basePath, {".snapshot", ".journal.old", ".journal"});
+    if (outPath.empty())
+    {
+        outPath = basePath + ".json";
+    }
+    if (!ifstream(basePath + ".snapshot").is_open())
+    {
+        cerr << "Error: no mempool snapshot at " << basePath << ".snapshot\n";
+        return 1;
+    }
+
+    // Main nodes pool completed games, players pool moves
+    bool games = endsWith(basePath, "_mainMempool");
+    json mempoolJson = json::array();
+    try
+    {
+        // Read-only replay; a node may still be appending to these files
+        for (const auto &entry : MempoolJournal::read(basePath))
+        {
+            if (games)
+            {
+                Game txn = ChainCodec::decodeGame(entry);
+                mempoolJson.push_back({{"gameId", txn.gameId},
+                                       {"players", addressesJson(txn.players)},
+                                       {"winnerId", txn.winnerId.toHex()},
+                                       {"gameComplete", txn.gameComplete},
+                                       {"digest", txn.digest().toHex()}});
+            }
+            else
+            {
+                Move txn = ChainCodec::decodeMove(entry);
+                mempoolJson.push_back({{"id", txn.id},
+                                       {"sender", txn.sender.toHex()},
+                                       {"receiver", txn.receiver.toHex()},
+                                       {"move", txn.chessMove.toUci()},
+                                       {"digest", txn.digest().toHex()}});
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return writeJson(mempoolJson, outPath);
+}
+
+int ChainExport::exportGames(string basePath, string outPath)
+{
+    basePath = stripSuffix(basePath, {".dat"});
+    bool complete = endsWith(basePath, "_completeGames");
+    if (!complete && !endsWith(basePath, "_game"))
+    {
+        cerr << "Error: expected a <nodeId>_game.dat or <nodeId>_completeGames.dat file\n";
+        return 1;
+    }
+    if (outPath.empty())
+    {
+        outPath = complete ? basePath + ".json" : stripSuffix(basePath, {"_game"}) + "_blockchain.json";
+    }
+
+    ifstream in(basePath + ".dat", ios::binary);
+    if (!in.is_open())
+    {
+        cerr << "Error: no game file at " << basePath << ".dat\n";
+        return 1;
+    }
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    json gamesJson = json::array();
+    try
+    {
+        if (complete)
+        {
+            // Length-prefixed game records, oldest first
+            ByteReader reader(data);
+            while (!reader.done())
+            {
+                gamesJson.push_back(gameBlocksJson(RecordView(reader.readStringView()).game()));
+            }
+        }
+        else
+        {
+            gamesJson = gameBlocksJson(RecordView(data).game());
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return writeJson(gamesJson, outPath);
+}
+
+int ChainExport::mergeMoves(string dir, string outPath)
+{
+    while (dir.size() > 1 && dir.back() == '/')
+    {
+        dir.pop_back();
+    }
+    if (outPath.empty())
+    {
+        outPath = dir + "/moves.json";
+    }
+
+    DIR *handle = opendir(dir.c_str());
+    if (handle == nullptr)
+    {
+        cerr << "Error: cannot open directory " << dir << "\n";
+        return 1;
+    }
+    vector<string> nodes;
+    while (dirent *file = readdir(handle))
+    {
+        string name = file->d_name;
+        if (endsWith(name, "_moves.journal"))
+        {
+            nodes.push_back(stripSuffix(name, {"_moves.journal"}));
+        }
+    }
+    closedir(handle);
+    sort(nodes.begin(), nodes.end());
+
+    json movesJson = json::array();
+    try
+    {
+        vector<vector<MoveJournalEntry>> journals;
+        for (const auto &node : nodes)
+        {
+            journals.push_back(MoveJournal::read(dir + "/" + node + "_moves.journal"));
+        }
+
+        // Each journal is already in time order, so a k-way merge on (timestamp, node, sequence) suffices
+        using Head = tuple<uint64_t, size_t, size_t>; // Timestamp, journal, position
+        priority_queue<Head, vector<Head>, greater<Head>> heads;
+        for (size_t j = 0; j < journals.size(); j++)
+        {
+            if (!journals[j].empty())
+            {
+                heads.emplace(journals[j][0].timestamp, j, 0);
+            }
+        }
+        while (!heads.empty())
+        {
+            auto [timestamp, j, position] = heads.top();
+            heads.pop();
+            const MoveJournalEntry &entry = journals[j][position];
+            MoveView move = RecordView(entry.record).move();
+            movesJson.push_back({{"timestamp", timestamp},
+                                 {"node", nodes[j]},
+                                 {"sequence", entry.sequence},
+                                 {"id", move.id()},
+                                 {"sender", move.sender().toHex()},
+                                 {"receiver", move.receiver().toHex()},
+                                 {"move", move.chessMove().toUci()},
+                                 {"digest", move.digest().toHex()}});
+            if (position + 1 < journals[j].size())
+            {
+                heads.emplace(journals[j][position + 1].timestamp, j, position + 1);
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    cout << "Merged " << nodes.size() << " move journals" << endl;
+    return writeJson(movesJson, outPath);
+}
@@ -0,0 +1,24 @@
+#ifndef CHAINEXPORT_HPP
+#define CHAINEXPORT_HPP
+
+#include <string>
+
+// Offline conversion of the binary node files to the JSON the viewers read. Both take
+// the file path with or without its extension; the output defaults to <base>.json.
+// They return a process exit code and report errors on stderr.
+class ChainExport
+{
+public:
+    // <nodeId>_mainBlockchain.log
+    static int exportChain(std::string basePath, std::string outPath = "");
+    // <nodeId>_mainMempool or <nodeId>_mempool snapshot and journal
+    static int exportMempool(std::string basePath, std::string outPath = "");
+    // A player's <nodeId>_game.dat or <nodeId>_completeGames.dat; the output defaults to the
+    // names the game viewer looks for, <nodeId>_blockchain.json / <nodeId>_completeGames.json
+    static int exportGames(std::string basePath, std::string outPath = "");
+    // Every <nodeId>_moves.journal in a directory, merged into one time-ordered list;
+    // the output defaults to <dir>/moves.json
+    static int mergeMoves(std::string dir, std::string outPath = "");
+};
+
+#endif
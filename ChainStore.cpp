@@ -0,0 +1,148 @@
+#include "ChainStore.hpp"
+#include "Bytes.hpp"
+#include "ChainCodec.hpp"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const unsigned char *mapFile(const string &path, size_t &size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Failed to open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw runtime_error("Failed to stat " + path);
+    }
+    size = (size_t)info.st_size;
+    void *data = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : nullptr;
+    ::close(fd); // The mapping keeps the file alive
+    if (data == MAP_FAILED)
+    {
+        throw runtime_error("Failed to map " + path);
+    }
+    return static_cast<const unsigned char *>(data);
+}
+
+static bool hasHeader(const unsigned char *data, size_t size, const string &magic, uint32_t version)
+{
+    return size >= BlockLog::HEADER_SIZE && string(reinterpret_cast<const char *>(data), magic.size()) == magic &&
+           readUint32At(data + magic.size()) == version;
+}
+
+ChainStore::ChainStore(const string &basePath) : logPath(basePath + ".log"), indexPath(basePath + ".idx")
+{
+    map();
+}
+
+void ChainStore::map()
+{
+    logData = mapFile(logPath, logSize);
+    indexData = mapFile(indexPath, indexSize);
+    if (!hasHeader(logData, logSize, BlockLog::MAGIC, BlockLog::VERSION) ||
+        !hasHeader(indexData, indexSize, BlockLog::INDEX_MAGIC, BlockLog::INDEX_VERSION))
+    {
+        unmap();
+        throw runtime_error("Not a block log: " + logPath);
+    }
+
+    // The writer appends the record before its row, but a reader can still catch a
+    // partly written row, or a row whose record was cut off by a crash
+    count = (indexSize - BlockLog::HEADER_SIZE) / BlockIndexEntry::SIZE;
+    while (count > 0)
+    {
+        BlockIndexEntry last = entry(count - 1);
+        if (last.offset + BlockLog::RECORD_HEADER_SIZE + last.length <= logSize)
+            break;
+        count--;
+    }
+}
+
+void ChainStore::unmap()
+{
+    if (logData)
+        munmap(const_cast<unsigned char *>(logData), logSize);
+    if (indexData)
+        munmap(const_cast<unsigned char *>(indexData), indexSize);
+    logData = indexData = nullptr;
+    logSize = indexSize = count = 0;
+}
+
+size_t ChainStore::refresh()
+{
+    unmap();
+    map();
+    return count;
+}
+
+size_t ChainStore::size() const
+{
+    return count;
+}
+
+BlockIndexEntry ChainStore::entry(size_t height) const
+{
+    if (height >= (indexSize - BlockLog::HEADER_SIZE) / BlockIndexEntry::SIZE)
+    {
+        throw out_of_range("No block at height " + to_string(height) + " in " + indexPath);
+    }
+    return BlockIndexEntry::decode(indexData + BlockLog::HEADER_SIZE + height * BlockIndexEntry::SIZE);
+}
+
+vector<BlockIndexEntry> ChainStore::entries(size_t from, size_t to) const
+{
+    vector<BlockIndexEntry> out;
+    to = min(to, count);
+    for (size_t height = from; height < to; height++)
+    {
+        out.push_back(entry(height));
+    }
+    return out;
+}
+
+string_view ChainStore::record(size_t height) const
+{
+    if (height >= count)
+    {
+        throw out_of_range("No block at height " + to_string(height) + " in " + logPath);
+    }
+    BlockIndexEntry row = entry(height);
+    if (row.offset < BlockLog::HEADER_SIZE || row.offset + BlockLog::RECORD_HEADER_SIZE + row.length > logSize)
+    {
+        throw runtime_error("Index points outside " + logPath + " at height " + to_string(height));
+    }
+    const unsigned char *record = logData + row.offset;
+    if (readUint32At(record) != row.length)
+    {
+        throw runtime_error("Index and log disagree at height " + to_string(height));
+    }
+    const unsigned char *payload = record + BlockLog::RECORD_HEADER_SIZE;
+    if (crc32(payload, row.length) != readUint32At(record + 4))
+    {
+        throw runtime_error("Checksum mismatch at height " + to_string(height));
+    }
+    return string_view(reinterpret_cast<const char *>(payload), row.length);
+}
+
+MainBlock ChainStore::block(size_t height) const
+{
+    return ChainCodec::decode(string(record(height)));
+}
+
+MainBlockView ChainStore::view(size_t height) const
+{
+    return RecordView(record(height)).mainBlock();
+}
+
+ChainStore::~ChainStore()
+{
+    unmap();
+}
@@ -0,0 +1,50 @@
+#ifndef CHAINSTORE_HPP
+#define CHAINSTORE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BlockLog.hpp"
+
+// Read-only view of a BlockLog for tools and other processes. Both files are mapped
+// shared and read-only, so any number of readers use the same page cache. Header rows
+// are fixed width, so entry(n) and entries(from, to) are plain offset arithmetic; only
+// block(n) and view(n) touch the log, and only the bytes of that one record.
+class ChainStore
+{
+private:
+    std::string logPath;
+    std::string indexPath;
+    const unsigned char *logData = nullptr;
+    size_t logSize = 0;
+    const unsigned char *indexData = nullptr;
+    size_t indexSize = 0;
+    size_t count = 0; // Rows whose record is fully inside the mapped log
+
+    void map();
+    void unmap();
+    // Payload bytes of one record inside the mapping, after its CRC is checked
+    std::string_view record(size_t height) const;
+
+public:
+    // Throws runtime_error if either file is missing or not a block log
+    explicit ChainStore(const std::string &basePath);
+    ChainStore(const ChainStore &) = delete;
+    ChainStore &operator=(const ChainStore &) = delete;
+
+    // Maps the files again to see blocks appended since; not safe against concurrent reads
+    size_t refresh();
+    size_t size() const;
+
+    BlockIndexEntry entry(size_t height) const;
+    // Rows [from, to), clamped to size()
+    std::vector<BlockIndexEntry> entries(size_t from, size_t to) const;
+    // Checks the record's CRC and decodes it
+    MainBlock block(size_t height) const;
+    // Same checks, but reads the record in place; valid until refresh() or destruction
+    MainBlockView view(size_t height) const;
+
+    ~ChainStore();
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "Checkpoint.hpp"
+#include "Bytes.hpp"
+#include "DurableWriter.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static const string MAGIC = "CCCP";
+static const uint32_t VERSION = 1;
+
+const char *Checkpoint::DEFAULT_PATH = "./data/checkpoint.dat";
+
+size_t CheckpointEntry::trustedHeight(const vector<Hash256> &chainHashes) const
+{
+    if (height == 0 || height > chainHashes.size() || chainHashes[height - 1] != tip)
+    {
+        return 0;
+    }
+    return height;
+}
+
+Checkpoint Checkpoint::load(const string &path)
+{
+    Checkpoint checkpoint;
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+    {
+        return checkpoint;
+    }
+
+    ostringstream contents;
+    contents << in.rdbuf();
+    string data = contents.str();
+
+    ByteReader reader(data);
+    if (reader.readBytes(MAGIC.size()) != MAGIC || reader.readUint32() != VERSION)
+    {
+        throw runtime_error("Unrecognised checkpoint " + path);
+    }
+    uint32_t count = reader.readUint32();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CheckpointEntry entry;
+        entry.kind = (CheckpointKind)reader.readUint8();
+        entry.id = reader.readString();
+        entry.height = reader.readUint64();
+        entry.tip = readHash(reader);
+        checkpoint.entries.push_back(entry);
+    }
+    if (!reader.done())
+    {
+        throw runtime_error("Trailing bytes in checkpoint " + path);
+    }
+    return checkpoint;
+}
+
+void Checkpoint::save(const string &path) const
+{
+    string data = MAGIC;
+    appendUint32(data, VERSION);
+    appendUint32(data, (uint32_t)entries.size());
+    for (const auto &entry : entries)
+    {
+        appendUint8(data, (uint8_t)entry.kind);
+        appendString(data, entry.id);
+        appendUint64(data, entry.height);
+        appendHash(data, entry.tip);
+    }
+    DurableWriter::instance().replace(path, data, FileClass::Blockchain);
+}
+
+void Checkpoint::add(const CheckpointEntry &entry)
+{
+    entries.push_back(entry);
+}
+
+const CheckpointEntry *Checkpoint::find(const string &id) const
+{
+    for (const auto &entry : entries)
+    {
+        if (entry.id == id)
+            return &entry;
+    }
+    return nullptr;
+}
+
+vector<string> Checkpoint::idsOf(CheckpointKind kind) const
+{
+    vector<string> ids;
+    for (const auto &entry : entries)
+    {
+        if (entry.kind == kind)
+            ids.push_back(entry.id);
+    }
+    return ids;
+}
+
+bool Checkpoint::empty() const
+{
+    return entries.empty();
+}
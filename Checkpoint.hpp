@@ -0,0 +1,60 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Hash256.hpp"
+
+enum class CheckpointKind : uint8_t
+{
+    MainNode = 1,
+    Player = 2
+};
+
+// Validated tip of one node's chain; for a player, its in-progress game
+struct CheckpointEntry
+{
+    CheckpointKind kind = CheckpointKind::MainNode;
+    std::string id; // MainNode id in decimal, player address in hex
+    uint64_t height = 0; // Blocks in the chain, 0 when a player has no game
+    Hash256 tip;
+
+    // Blocks of `chainHashes` below this height are covered by the checkpoint, if the tip is still there
+    size_t trustedHeight(const std::vector<Hash256> &chainHashes) const;
+};
+
+// What each node had when the process last came up or shut down cleanly, after validation.
+// A restart with --recover trusts persisted blocks up to these tips and re-validates only
+// what was written after them. The file is a magic/version header and one record per node
+// (kind byte, length-prefixed id, height, tip), replaced whole through DurableWriter.
+class Checkpoint
+{
+private:
+    std::vector<CheckpointEntry> entries;
+
+public:
+    static const char *DEFAULT_PATH;
+
+    // Empty if the file does not exist; throws runtime_error if it is malformed
+    static Checkpoint load(const std::string &path = DEFAULT_PATH);
+    void save(const std::string &path = DEFAULT_PATH) const;
+
+    void add(const CheckpointEntry &entry);
+    const CheckpointEntry *find(const std::string &id) const;
+    // Ids of one kind, in the order they were added
+    std::vector<std::string> idsOf(CheckpointKind kind) const;
+    bool empty() const;
+};
+
+// What a node rebuilt from its persisted stores at startup
+struct RecoveryStats
+{
+    size_t trustedBlocks = 0;  // Covered by the checkpoint, only checked for linkage
+    size_t verifiedBlocks = 0; // Written after the checkpoint, fully validated
+    size_t droppedBlocks = 0;  // Failed validation, cut from the store with everything after
+    size_t ratingReplays = 0; // Blocks whose ratings were replayed rather than read from a snapshot
+    size_t queuedTransactions = 0;
+};
+
+#endif
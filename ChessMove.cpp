@@ -0,0 +1,78 @@
+#include "ChessMove.hpp"
+#include <stdexcept>
+
+using namespace std;
+
+static const string PROMOTION_LETTERS = " nbrq";
+
+ChessMove::ChessMove(int from, int to, Promotion promotion)
+{
+    if (from < 0 || from > 63 || to < 0 || to > 63 || (uint8_t)promotion > (uint8_t)Promotion::Queen)
+    {
+        throw invalid_argument("Chess move out of range");
+    }
+    bits = (uint16_t)(from | to << 6 | (int)promotion << 12);
+}
+
+ChessMove ChessMove::fromPacked(uint16_t packed)
+{
+    ChessMove move;
+    move.bits = packed;
+    return move;
+}
+
+static int parseSquare(const string &uci, size_t pos)
+{
+    char file = uci[pos];
+    char rank = uci[pos + 1];
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8')
+    {
+        throw invalid_argument("Invalid square in UCI move: " + uci);
+    }
+    return (rank - '1') * 8 + (file - 'a');
+}
+
+ChessMove ChessMove::fromUci(const string &uci)
+{
+    if (uci.size() != 4 && uci.size() != 5)
+    {
+        throw invalid_argument("Invalid UCI move: " + uci);
+    }
+
+    Promotion promotion = Promotion::None;
+    if (uci.size() == 5)
+    {
+        size_t piece = PROMOTION_LETTERS.find(uci[4]);
+        if (piece == string::npos || piece == 0)
+        {
+            throw invalid_argument("Invalid promotion piece in UCI move: " + uci);
+        }
+        promotion = (Promotion)piece;
+    }
+
+    ChessMove move(parseSquare(uci, 0), parseSquare(uci, 2), promotion);
+    if (!move.isValid())
+    {
+        throw invalid_argument("Null move: " + uci);
+    }
+    return move;
+}
+
+bool ChessMove::isValid() const
+{
+    return from() != to() && (uint8_t)promotion() <= (uint8_t)Promotion::Queen;
+}
+
+string ChessMove::toUci() const
+{
+    string uci;
+    uci += (char)('a' + from() % 8);
+    uci += (char)('1' + from() / 8);
+    uci += (char)('a' + to() % 8);
+    uci += (char)('1' + to() / 8);
+    if (promotion() != Promotion::None && isValid())
+    {
+        uci += PROMOTION_LETTERS[(int)promotion()];
+    }
+    return uci;
+}
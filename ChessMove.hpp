@@ -0,0 +1,45 @@
+#ifndef CHESSMOVE_HPP
+#define CHESSMOVE_HPP
+
+#include <cstdint>
+#include <string>
+
+enum class Promotion : uint8_t
+{
+    None = 0,
+    Knight = 1,
+    Bishop = 2,
+    Rook = 3,
+    Queen = 4
+};
+
+// A chess move packed into 16 bits: from square in bits 0-5, to square in bits 6-11
+// (a1 = 0 ... h8 = 63) and the promotion piece in bits 12-15. This is the form that is
+// hashed, signed and stored; UCI text ("e2e4", "e7e8q") only appears at the API edge.
+class ChessMove
+{
+private:
+    uint16_t bits = 0;
+
+public:
+    ChessMove() = default;
+    ChessMove(int from, int to, Promotion promotion = Promotion::None);
+
+    static ChessMove fromPacked(uint16_t packed);
+    // Throws invalid_argument on anything that is not a well-formed UCI move
+    static ChessMove fromUci(const std::string &uci);
+
+    int from() const { return bits & 0x3F; }
+    int to() const { return (bits >> 6) & 0x3F; }
+    Promotion promotion() const { return (Promotion)(bits >> 12); }
+    uint16_t packed() const { return bits; }
+
+    // False for the zero value, a null move or an unknown promotion piece
+    bool isValid() const;
+    std::string toUci() const;
+
+    bool operator==(const ChessMove &other) const { return bits == other.bits; }
+    bool operator!=(const ChessMove &other) const { return bits != other.bits; }
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include "DurableWriter.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+const chrono::microseconds DurableWriter::GROUP_WINDOW(2000);
+
+static string directoryOf(const string &path)
+{
+    size_t slash = path.find_last_of('/');
+    if (slash == string::npos)
+        return ".";
+    if (slash == 0)
+        return "/";
+    return path.substr(0, slash);
+}
+
+static string systemError(const string &what, const string &path)
+{
+    return what + " " + path + ": " + strerror(errno);
+}
+
+DurableWriter::DurableWriter()
+{
+    policies[(size_t)FileClass::Blockchain] = Durability::Sync;
+    policies[(size_t)FileClass::Mempool] = Durability::Group;
+    policies[(size_t)FileClass::Games] = Durability::Group;
+    policies[(size_t)FileClass::Keystore] = Durability::Sync;
+}
+
+DurableWriter &DurableWriter::instance()
+{
+    static DurableWriter writer;
+    return writer;
+}
+
+DurableWriter::~DurableWriter()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    work.notify_all();
+    if (syncer.joinable())
+    {
+        syncer.join();
+    }
+}
+
+void DurableWriter::setDurability(FileClass fileClass, Durability durability)
+{
+    lock_guard<mutex> lock(mtx);
+    policies[(size_t)fileClass] = durability;
+}
+
+Durability DurableWriter::durability(FileClass fileClass) const
+{
+    lock_guard<mutex> lock(mtx);
+    return policies[(size_t)fileClass];
+}
+
+// Directories are opened read-only too; fsync on the descriptor flushes their entries
+void DurableWriter::syncPath(const string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw runtime_error(systemError("Failed to open", path));
+    }
+    int result = fsync(fd);
+    int savedErrno = errno;
+    close(fd);
+    if (result != 0)
+    {
+        errno = savedErrno;
+        throw runtime_error(systemError("Failed to fsync", path));
+    }
+}
+
+void DurableWriter::syncNow(const string &path)
+{
+    syncPath(path);
+    lock_guard<mutex> lock(mtx);
+    stats.commits++;
+    stats.fsyncs++;
+}
+
+void DurableWriter::groupCommit(const vector<string> &paths)
+{
+    unique_lock<mutex> lock(mtx);
+    if (!syncer.joinable())
+    {
+        syncer = thread(&DurableWriter::syncerLoop, this);
+    }
+    pending.insert(paths.begin(), paths.end());
+    uint64_t round = openRound;
+    openWaiters++;
+    stats.commits += paths.size();
+    work.notify_one();
+    done.wait(lock, [&]
+              { return syncedRound >= round; });
+    auto failed = failures.find(round);
+    if (failed != failures.end())
+    {
+        string error = failed->second.first;
+        if (--failed->second.second == 0)
+        {
+            failures.erase(failed);
+        }
+        throw runtime_error("Group commit failed: " + error);
+    }
+}
+
+void DurableWriter::syncerLoop()
+{
+    unique_lock<mutex> lock(mtx);
+    while (true)
+    {
+        work.wait(lock, [&]
+                  { return stopping || !pending.empty(); });
+        if (pending.empty())
+        {
+            break;
+        }
+
+        // Hold the round open briefly so concurrent updates share its fsyncs
+        if (!stopping)
+        {
+            work.wait_for(lock, GROUP_WINDOW, [&]
+                          { return stopping; });
+        }
+        set<string> batch;
+        batch.swap(pending);
+        uint64_t round = openRound++;
+        size_t waiters = openWaiters;
+        openWaiters = 0;
+        lock.unlock();
+
+        string error;
+        for (const auto &path : batch)
+        {
+            try
+            {
+                syncPath(path);
+            }
+            catch (const exception &e)
+            {
+                error = e.what();
+            }
+        }
+
+        lock.lock();
+        stats.fsyncs += batch.size();
+        stats.batches++;
+        if (!error.empty())
+        {
+            failures[round] = {error, waiters};
+        }
+        syncedRound = round;
+        done.notify_all();
+    }
+}
+
+void DurableWriter::makeDurable(const string &path, Durability durability)
+{
+    if (durability == Durability::Sync)
+        syncNow(path);
+    else if (durability == Durability::Group)
+        groupCommit({path});
+}
+
+void DurableWriter::replace(const string &path, const string &data, FileClass fileClass, mode_t mode)
+{
+    Durability policy = durability(fileClass);
+    // Unique per call so concurrent writers of one file never share a temporary
+    string temp = path + ".tmp" + to_string(tempCounter++);
+
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+    if (fd < 0)
+    {
+        throw runtime_error(systemError("Failed to open", temp));
+    }
+    fchmod(fd, mode);
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            string message = systemError("Failed to write", temp);
+            close(fd);
+            unlink(temp.c_str());
+            throw runtime_error(message);
+        }
+        written += n;
+    }
+    close(fd);
+
+    try
+    {
+        makeDurable(temp, policy);
+    }
+    catch (...)
+    {
+        unlink(temp.c_str());
+        throw;
+    }
+    if (rename(temp.c_str(), path.c_str()) != 0)
+    {
+        string message = systemError("Failed to replace", path);
+        unlink(temp.c_str());
+        throw runtime_error(message);
+    }
+    makeDurable(directoryOf(path), policy);
+}
+
+void DurableWriter::commit(const string &path, FileClass fileClass, bool created)
+{
+    Durability policy = durability(fileClass);
+    makeDurable(path, policy);
+    if (created)
+    {
+        makeDurable(directoryOf(path), policy);
+    }
+}
+
+void DurableWriter::commit(const vector<string> &paths, FileClass fileClass)
+{
+    Durability policy = durability(fileClass);
+    if (paths.empty())
+    {
+        return;
+    }
+    if (policy == Durability::Group)
+    {
+        groupCommit(paths);
+        return;
+    }
+    for (const auto &path : paths)
+    {
+        makeDurable(path, policy);
+    }
+}
+
+DurableStats DurableWriter::getStats() const
+{
+    lock_guard<mutex> lock(mtx);
+    return stats;
+}
+
+Durability DurableWriter::parseDurability(const string &name)
+{
+    if (name == "none")
+        return Durability::None;
+    if (name == "group")
+        return Durability::Group;
+    if (name == "sync")
+        return Durability::Sync;
+    throw runtime_error("Unknown durability '" + name + "' (expected none, group or sync)");
+}
+
+FileClass DurableWriter::parseFileClass(const string &name)
+{
+    if (name == "blockchain")
+        return FileClass::Blockchain;
+    if (name == "mempool")
+        return FileClass::Mempool;
+    if (name == "games")
+        return FileClass::Games;
+    if (name == "keystore")
+        return FileClass::Keystore;
+    throw runtime_error("Unknown file class '" + name + "' (expected blockchain, mempool, games or keystore)");
+}
+
+void DurableWriter::configure(const string &settings)
+{
+    size_t start = 0;
+    while (start <= settings.size())
+    {
+        size_t end = settings.find(',', start);
+        if (end == string::npos)
+            end = settings.size();
+        string item = settings.substr(start, end - start);
+        size_t eq = item.find('=');
+        if (eq == string::npos)
+        {
+            throw runtime_error("Expected class=mode, got '" + item + "'");
+        }
+        setDurability(parseFileClass(item.substr(0, eq)), parseDurability(item.substr(eq + 1)));
+        start = end + 1;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef DURABLEWRITER_HPP
+#define DURABLEWRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+// What a write has to survive before the call returns
+enum class Durability : uint8_t
+{
+    None,  // Page cache only; a crash can lose it, but a replaced file is never torn
+    Group, // fsync shared with every other update in the same short window
+    Sync   // fsync of its own
+};
+
+enum class FileClass : uint8_t
+{
+    Blockchain, // Block log and player game chains
+    Mempool,    // Mempool journals and snapshots
+    Games,      // Completed games waiting for a main node
+    Keystore,
+    Count
+};
+
+struct DurableStats
+{
+    uint64_t commits = 0; // Logical updates made durable (Group or Sync)
+    uint64_t fsyncs = 0;  // fsync calls issued
+    uint64_t batches = 0; // Group commit rounds
+};
+
+// Crash-safe writes for node state. replace() writes a temporary file, makes it durable,
+// renames it over the target and makes the rename durable, so readers only ever see the
+// old or the new contents. commit() makes bytes already written to an append-only file
+// durable. Group commit waits up to GROUP_WINDOW for other updates and covers them all
+// with one fsync per distinct file; the caller returns once its update is on disk.
+class DurableWriter
+{
+private:
+    Durability policies[(size_t)FileClass::Count];
+    mutable std::mutex mtx;
+    std::condition_variable work; // Wakes the syncer
+    std::condition_variable done; // Wakes callers when a round completes
+    std::set<std::string> pending; // Paths waiting for the next group round
+    uint64_t openRound = 1;        // Round that new commits join
+    uint64_t syncedRound = 0;      // Last round whose fsyncs completed
+    size_t openWaiters = 0;        // Callers waiting on openRound
+    // Error of each failed round still being read; every waiter takes one share and the
+    // last one erases it, so a later failure can't hide an earlier round's
+    std::map<uint64_t, std::pair<std::string, size_t>> failures;
+    bool stopping = false;
+    std::thread syncer;
+    DurableStats stats;
+    std::atomic<uint64_t> tempCounter{0};
+
+    DurableWriter();
+    void syncerLoop();
+    static void syncPath(const std::string &path);
+    void syncNow(const std::string &path);
+    void groupCommit(const std::vector<std::string> &paths);
+    void makeDurable(const std::string &path, Durability durability);
+
+public:
+    static const std::chrono::microseconds GROUP_WINDOW;
+
+    static DurableWriter &instance();
+
+    void setDurability(FileClass fileClass, Durability durability);
+    Durability durability(FileClass fileClass) const;
+
+    // Atomically replaces `path` with `data`; throws runtime_error on failure
+    void replace(const std::string &path, const std::string &data, FileClass fileClass, mode_t mode = 0644);
+    // Makes what was already flushed to `path` durable; `created` also covers its directory entry
+    void commit(const std::string &path, FileClass fileClass, bool created = false);
+    // Same for several files at once; under Group they all join one round
+    void commit(const std::vector<std::string> &paths, FileClass fileClass);
+
+    DurableStats getStats() const;
+
+    static Durability parseDurability(const std::string &name);
+    static FileClass parseFileClass(const std::string &name);
+    // Applies "class=mode[,class=mode...]", e.g. "mempool=none,blockchain=group"
+    void configure(const std::string &settings);
+
+    ~DurableWriter();
+};
+
+#endif
@@ -3,11 +3,13 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <cassert>
 #include "Game.hpp"
+#include "Bytes.hpp"
 
 using namespace std;
 
-Game::Game(vector<string> players)
+Game::Game(vector<Address> players)
 {
     if (players.size() < 2)
     {
@@ -18,18 +20,36 @@ Game::Game(vector<string> players)
     this->gameComplete = false;
     chain.push_back(createGenesisBlock());
     this->players = players;
-    this->winnerId = "";
+    this->winnerId = Address{};
 }
 Game::Game()
 {
     chain.push_back(createGenesisBlock());
-    this->winnerId = "";
+    this->winnerId = Address{};
+}
+
+Game::Game(int gameId, vector<Address> players, Address winnerId, bool gameComplete, vector<BlockGame> chain)
+{
+    if (chain.empty())
+    {
+        throw runtime_error("A game needs at least its genesis block.");
+    }
+
+    this->gameId = gameId;
+    this->players = players;
+    this->winnerId = winnerId;
+    this->gameComplete = gameComplete;
+    this->chain = chain;
+    if (gameComplete)
+    {
+        seal();
+    }
 }
 
 BlockGame Game::createGenesisBlock()
 {
     vector<Move> genesisMoves = {};
-    return BlockGame(0, "0", genesisMoves);
+    return BlockGame(0, Hash256{}, genesisMoves);
 }
 
 void Game::addBlock(BlockGame newBlock)
@@ -48,7 +68,7 @@ BlockGame Game::getLastBlock()
 
 void Game::endGame()
 {
-    if (this->winnerId != "")
+    if (!this->winnerId.isZero())
     {
         cerr << "Game already ended";
     }
@@ -56,6 +76,7 @@ void Game::endGame()
     {
         this->winnerId = chain.back().moves[0].receiver;
         gameComplete = true;
+        seal();
         cout << "Game ended. Winner is player with ID: " << winnerId << endl;
     }
     else
@@ -64,7 +85,76 @@ void Game::endGame()
     }
 }
 
+string Game::encodeCanonical() const
+{
+    string out;
+    appendUint32(out, (uint32_t)gameId);
+    appendUint32(out, (uint32_t)players.size());
+    for (const auto &player : players)
+    {
+        out.append(reinterpret_cast<const char *>(player.data()), player.size());
+    }
+    out.append(reinterpret_cast<const char *>(winnerId.data()), winnerId.size());
+    appendUint8(out, gameComplete ? 1 : 0);
+    appendUint32(out, (uint32_t)chain.size());
+    for (const auto &block : chain)
+    {
+        appendUint32(out, (uint32_t)block.index);
+        out.append(reinterpret_cast<const char *>(block.hash.data()), block.hash.size());
+    }
+    return out;
+}
+
+void Game::seal()
+{
+    cachedCanonical = encodeCanonical();
+    cachedDigest = Sha256::hash(cachedCanonical);
+    cachedString = describe();
+    sealed = true;
+}
+
+bool Game::isSealed() const
+{
+    return sealed;
+}
+
+void Game::checkUnchanged() const
+{
+    // Debug builds re-encode on every access to catch a field changed after sealing
+    assert(encodeCanonical() == cachedCanonical && "Game modified after it was sealed");
+}
+
+string Game::canonicalBytes() const
+{
+    if (!sealed)
+        return encodeCanonical();
+#ifndef NDEBUG
+    checkUnchanged();
+#endif
+    return cachedCanonical;
+}
+
+Sha256::Digest Game::digest() const
+{
+    if (!sealed)
+        return Sha256::hash(encodeCanonical());
+#ifndef NDEBUG
+    checkUnchanged();
+#endif
+    return cachedDigest;
+}
+
 string Game::toString() const
+{
+    if (!sealed)
+        return describe();
+#ifndef NDEBUG
+    checkUnchanged();
+#endif
+    return cachedString;
+}
+
+string Game::describe() const
 {
     std::ostringstream ss;
     ss << "Game ID: " << gameId << "\n";
@@ -74,7 +164,7 @@ string Game::toString() const
         ss << player << " ";
     }
     ss << "\n";
-    ss << "Winner ID: " << (winnerId.empty() ? "None" : winnerId) << "\n";
+    ss << "Winner ID: " << (winnerId.isZero() ? "None" : winnerId.toHex()) << "\n";
     ss << "Game Complete: " << (gameComplete ? "Yes" : "No") << "\n";
     ss << "Chain Size: " << chain.size() << "\n";
     ss << "Moves:\n";
@@ -82,7 +172,7 @@ string Game::toString() const
     {
         for (const auto &move : block.moves)
         {
-            ss << "  Sender: " << move.sender << ", Receiver: " << move.receiver << ", Move: " << move.data << "\n";
+            ss << "  Sender: " << move.sender << ", Receiver: " << move.receiver << ", Move: " << move.chessMove.toUci() << "\n";
         }
     }
     return ss.str();
@@ -92,3 +182,8 @@ vector<BlockGame> Game::getChain() const
 {
     return chain;
 }
+
+int Game::requiredDifficulty(size_t height) const
+{
+    return height == 0 ? 0 : DIFFICULTY;
+}
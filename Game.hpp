@@ -6,6 +6,8 @@
 #include <string>
 #include "BlockGame.hpp"
 #include "Move.hpp"
+#include "Sha256.hpp"
+#include "KeyCache.hpp"
 
 using namespace std;
 
@@ -16,18 +18,38 @@ private:
 
     BlockGame createGenesisBlock();
 
+    // Filled by seal() once the game is complete and can no longer change
+    bool sealed = false;
+    string cachedCanonical;
+    string cachedString;
+    Sha256::Digest cachedDigest{};
+
+    string encodeCanonical() const;
+    string describe() const;
+    void checkUnchanged() const;
+    void seal();
+
 public:
-    Game(vector<string> players);
+    static const int DIFFICULTY = 16; // Leading zero bits every mined game block must meet
+
+    Game(vector<Address> players);
     Game();
+    // Rebuilds a persisted game with its blocks; seals it if it was complete
+    Game(int gameId, vector<Address> players, Address winnerId, bool gameComplete, vector<BlockGame> chain);
     int gameId;
-    vector<string> players;
-    string winnerId;
+    vector<Address> players;
+    Address winnerId; // All zeros until the game ends
 
     bool gameComplete = false;
 
     void addBlock(BlockGame newBlock);
     BlockGame getLastBlock();
     vector<BlockGame> getChain() const;
+    int requiredDifficulty(size_t height) const;
+    bool isSealed() const;
+    // Game id, players, winner, completion flag and the hash of every block
+    string canonicalBytes() const;
+    Sha256::Digest digest() const;
     string toString() const;
     void endGame();
 
@@ -0,0 +1,56 @@
+#include "Hash256.hpp"
+
+using namespace std;
+
+string Hash256::toHex() const
+{
+    static const char *digits = "0123456789abcdef";
+    string hex(size() * 2, '0');
+    for (size_t i = 0; i < size(); i++)
+    {
+        hex[i * 2] = digits[(*this)[i] >> 4];
+        hex[i * 2 + 1] = digits[(*this)[i] & 0x0f];
+    }
+    return hex;
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+Hash256 Hash256::fromHex(const string &hex)
+{
+    Hash256 hash{};
+    if (hex.size() != hash.size() * 2)
+    {
+        return hash;
+    }
+    for (size_t i = 0; i < hash.size(); i++)
+    {
+        int hi = hexValue(hex[i * 2]);
+        int lo = hexValue(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+        {
+            return Hash256{};
+        }
+        hash[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return hash;
+}
+
+bool Hash256::isZero() const
+{
+    for (uint8_t byte : *this)
+    {
+        if (byte != 0)
+            return false;
+    }
+    return true;
+}
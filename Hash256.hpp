@@ -0,0 +1,47 @@
+#ifndef HASH256_HPP
+#define HASH256_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// 32 byte SHA-256 value kept in binary; hex is only produced for JSON, logs and display
+struct Hash256 : std::array<uint8_t, 32>
+{
+    std::string toHex() const;
+    // Accepts a 64 character hex string; anything else (e.g. the old genesis "0") maps to all zeros
+    static Hash256 fromHex(const std::string &hex);
+
+    bool isZero() const;
+};
+
+inline std::ostream &operator<<(std::ostream &out, const Hash256 &hash)
+{
+    return out << hash.toHex();
+}
+
+namespace std
+{
+    template <>
+    struct hash<Hash256>
+    {
+        // Proof-of-work hashes start with zero bits by construction, so no single word can
+        // be trusted to vary; all four are folded together
+        size_t operator()(const Hash256 &value) const noexcept
+        {
+            uint64_t mixed = 0;
+            for (size_t offset = 0; offset < 32; offset += 8)
+            {
+                uint64_t word;
+                memcpy(&word, value.data() + offset, sizeof(word));
+                mixed = (mixed ^ word) * 0x9E3779B97F4A7C15ull;
+            }
+            return (size_t)(mixed ^ (mixed >> 32));
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "KeyCache.hpp"
+#include "Sha256.hpp"
+#include <mutex>
+#include <stdexcept>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+using namespace std;
+
+KeyCache &KeyCache::instance()
+{
+    static KeyCache cache;
+    return cache;
+}
+
+Address KeyCache::fingerprint(EVP_PKEY *key)
+{
+    unsigned char *der = nullptr;
+    int len = i2d_PUBKEY(key, &der);
+    if (len <= 0)
+    {
+        throw runtime_error("Failed to encode public key.");
+    }
+    Address address = Sha256::hash(der, (size_t)len);
+    OPENSSL_free(der);
+    return address;
+}
+
+KeyHandle KeyCache::wrap(EVP_PKEY *key)
+{
+    return KeyHandle(key, EVP_PKEY_free);
+}
+
+KeyHandle KeyCache::parsePrivateKey(const string &pem)
+{
+    BIO *bio = BIO_new_mem_buf(pem.data(), (int)pem.size());
+    EVP_PKEY *key = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    return key ? wrap(key) : nullptr;
+}
+
+EVP_MD_CTX *KeyCache::threadContext()
+{
+    thread_local unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    EVP_MD_CTX_reset(ctx.get());
+    return ctx.get();
+}
+
+Address KeyCache::registerKey(const string &pem)
+{
+    BIO *bio = BIO_new_mem_buf(pem.data(), (int)pem.size());
+    EVP_PKEY *key = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    if (!key)
+    {
+        throw runtime_error("Not a PEM public key.");
+    }
+
+    KeyHandle handle = wrap(key);
+    Address address = fingerprint(key);
+    unique_lock<shared_mutex> lock(mtx);
+    keys.emplace(address, Entry{pem, handle});
+    return address;
+}
+
+KeyHandle KeyCache::publicKey(const Address &address) const
+{
+    shared_lock<shared_mutex> lock(mtx);
+    auto it = keys.find(address);
+    return it == keys.end() ? nullptr : it->second.key;
+}
+
+string KeyCache::publicKeyPem(const Address &address) const
+{
+    shared_lock<shared_mutex> lock(mtx);
+    auto it = keys.find(address);
+    return it == keys.end() ? "" : it->second.pem;
+}
+
+size_t KeyCache::size() const
+{
+    shared_lock<shared_mutex> lock(mtx);
+    return keys.size();
+}
@@ -0,0 +1,49 @@
+#ifndef KEYCACHE_HPP
+#define KEYCACHE_HPP
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <openssl/evp.h>
+#include "Hash256.hpp"
+
+// Reference counted parsed key; safe to use for sign/verify from several threads at once
+using KeyHandle = std::shared_ptr<EVP_PKEY>;
+
+// Identifies a player everywhere (moves, games, ratings): SHA-256 of the DER public key
+using Address = Hash256;
+
+// Registry of public keys by address. Keys are parsed once when registered, and
+// the full key is only looked up to verify a signature.
+class KeyCache
+{
+private:
+    struct Entry
+    {
+        std::string pem;
+        KeyHandle key;
+    };
+
+    mutable std::shared_mutex mtx;
+    std::unordered_map<Address, Entry> keys;
+
+public:
+    static KeyCache &instance();
+
+    static Address fingerprint(EVP_PKEY *key);
+    static KeyHandle wrap(EVP_PKEY *key);
+    // Parses without caching; players hold their own private key for their lifetime
+    static KeyHandle parsePrivateKey(const std::string &pem);
+    // Message digest context owned by the calling thread, reset and ready for another Init
+    static EVP_MD_CTX *threadContext();
+
+    // Parses the PEM and returns its address; throws if it holds no public key
+    Address registerKey(const std::string &pem);
+    // Null / empty for an address that was never registered
+    KeyHandle publicKey(const Address &address) const;
+    std::string publicKeyPem(const Address &address) const;
+    size_t size() const;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "KeyPool.hpp"
+#include <iostream>
+
+using namespace std;
+
+const chrono::milliseconds KeyPool::FAILURE_BACKOFF(1000);
+
+KeyPool &KeyPool::instance()
+{
+    static KeyPool pool;
+    return pool;
+}
+
+void KeyPool::start(SignatureAlgorithm algorithm, size_t lowWaterMark, unsigned int threads)
+{
+    stop();
+    if (threads == 0)
+    {
+        threads = thread::hardware_concurrency();
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+
+    {
+        lock_guard<mutex> lock(mtx);
+        this->algorithm = algorithm;
+        this->lowWaterMark = lowWaterMark;
+        ready.clear();
+        running = true;
+    }
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&KeyPool::workerLoop, this);
+    }
+}
+
+void KeyPool::workerLoop()
+{
+    bool filling = false;
+    while (true)
+    {
+        SignatureAlgorithm target;
+        {
+            unique_lock<mutex> lock(mtx);
+            // Fill to twice the low-water mark, then sleep until it is crossed again
+            cv.wait(lock, [this, &filling]
+                    {
+                        size_t pending = ready.size() + inProgress;
+                        if (pending < lowWaterMark)
+                            filling = true;
+                        else if (pending >= lowWaterMark * 2)
+                            filling = false;
+                        return !running || filling; });
+            if (!running)
+            {
+                return;
+            }
+            inProgress++;
+            target = algorithm;
+        }
+
+        KeyHandle key;
+        try
+        {
+            key = SignatureScheme::get(target).generateKey();
+        }
+        catch (const exception &e)
+        {
+            cerr << "Error: Background key generation failed: " << e.what() << endl;
+            unique_lock<mutex> lock(mtx);
+            inProgress--;
+            counters.failedInBackground++;
+            // acquire() generates inline while the pool is empty, so only the retry waits
+            cv.wait_for(lock, FAILURE_BACKOFF, [this]
+                        { return !running; });
+            continue;
+        }
+
+        {
+            lock_guard<mutex> lock(mtx);
+            inProgress--;
+            ready.push_back(key);
+            counters.generatedInBackground++;
+        }
+        cv.notify_all();
+    }
+}
+
+void KeyPool::stop()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        running = false;
+    }
+    cv.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+}
+
+KeyHandle KeyPool::acquire(SignatureAlgorithm algorithm)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        if (!ready.empty() && this->algorithm == algorithm)
+        {
+            KeyHandle key = ready.front();
+            ready.pop_front();
+            counters.pooled++;
+            cv.notify_all(); // May have crossed the low-water mark
+            return key;
+        }
+        counters.generatedInline++;
+    }
+    return SignatureScheme::get(algorithm).generateKey();
+}
+
+KeyPoolStats KeyPool::stats()
+{
+    lock_guard<mutex> lock(mtx);
+    KeyPoolStats result = counters;
+    result.available = ready.size();
+    return result;
+}
+
+KeyPool::~KeyPool()
+{
+    stop();
+}
@@ -0,0 +1,56 @@
+#ifndef KEYPOOL_HPP
+#define KEYPOOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SignatureScheme.hpp"
+
+struct KeyPoolStats
+{
+    uint64_t pooled = 0;     // Keys handed out from the pool
+    uint64_t generatedInline = 0; // Keys generated on the caller's thread because the pool was empty
+    uint64_t generatedInBackground = 0;
+    uint64_t failedInBackground = 0; // Background generations that threw; callers fall back to inline
+    size_t available = 0;
+};
+
+// Key pairs generated ahead of demand on background threads. Once the number of
+// ready keys drops below the low-water mark the workers refill it to twice that.
+// A worker whose generation fails backs off for FAILURE_BACKOFF before retrying.
+class KeyPool
+{
+private:
+    SignatureAlgorithm algorithm = SignatureAlgorithm::RSA2048;
+    size_t lowWaterMark = 0;
+    std::deque<KeyHandle> ready;
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool running = false;
+    size_t inProgress = 0; // Keys being generated right now, counted towards the target
+    KeyPoolStats counters;
+
+    void workerLoop();
+
+public:
+    static const std::chrono::milliseconds FAILURE_BACKOFF;
+
+    static KeyPool &instance();
+
+    // threads == 0 uses the hardware concurrency. Restarting with other settings discards ready keys.
+    void start(SignatureAlgorithm algorithm, size_t lowWaterMark, unsigned int threads = 0);
+    void stop();
+
+    // A ready key if one matches the algorithm, otherwise one generated inline
+    KeyHandle acquire(SignatureAlgorithm algorithm);
+    KeyPoolStats stats();
+
+    ~KeyPool();
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "Keystore.hpp"
+#include "Bytes.hpp"
+#include "DurableWriter.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <openssl/pem.h>
+
+using namespace std;
+
+static const string MAGIC = "CCKS";
+static const uint32_t VERSION = 1;
+
+const char *Keystore::DEFAULT_PATH = "./keystore.dat";
+
+Keystore::Keystore(string path) : path(path)
+{
+}
+
+vector<KeyRecord> Keystore::load() const
+{
+    vector<KeyRecord> records;
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+    {
+        return records;
+    }
+
+    ostringstream contents;
+    contents << in.rdbuf();
+    string data = contents.str();
+
+    ByteReader reader(data);
+    if (reader.readBytes(MAGIC.size()) != MAGIC || reader.readUint32() != VERSION)
+    {
+        throw runtime_error("Unrecognised keystore " + path);
+    }
+
+    uint32_t count = reader.readUint32();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        KeyRecord record;
+        record.algorithm = (SignatureAlgorithm)reader.readUint8();
+        record.key = KeyCache::parsePrivateKey(reader.readString());
+        if (!record.key || SignatureScheme::algorithmOf(record.key.get()) != record.algorithm)
+        {
+            throw runtime_error("Corrupt key record " + to_string(i) + " in " + path);
+        }
+        records.push_back(record);
+    }
+    return records;
+}
+
+void Keystore::save(const vector<KeyRecord> &records) const
+{
+    string data = MAGIC;
+    appendUint32(data, VERSION);
+    appendUint32(data, (uint32_t)records.size());
+    for (const auto &record : records)
+    {
+        appendUint8(data, (uint8_t)record.algorithm);
+        appendString(data, SignatureScheme::privateKeyPem(record.key.get()));
+    }
+
+    DurableWriter::instance().replace(path, data, FileClass::Keystore, S_IRUSR | S_IWUSR);
+}
+
+const string &Keystore::getPath() const
+{
+    return path;
+}
@@ -0,0 +1,35 @@
+#ifndef KEYSTORE_HPP
+#define KEYSTORE_HPP
+
+#include <string>
+#include <vector>
+#include "SignatureScheme.hpp"
+
+// One player identity as stored on disk
+struct KeyRecord
+{
+    SignatureAlgorithm algorithm = SignatureAlgorithm::RSA2048;
+    KeyHandle key; // Private key; the public key and address are derived from it
+};
+
+// Player identities kept outside ./data, so they survive the reset at startup.
+// The file is a magic/version header followed by one record per player:
+// scheme byte, then the length-prefixed PEM private key. It is read in one go.
+class Keystore
+{
+private:
+    std::string path;
+
+public:
+    static const char *DEFAULT_PATH;
+
+    explicit Keystore(std::string path = DEFAULT_PATH);
+
+    // Empty if the file does not exist; throws runtime_error if it is malformed
+    std::vector<KeyRecord> load() const;
+    // Replaces the file; written to a temporary first and readable by the owner only
+    void save(const std::vector<KeyRecord> &records) const;
+    const std::string &getPath() const;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "Logger.hpp"
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+using json = nlohmann::json;
+
+static const size_t MAX_BATCH = 1024;
+static const auto IDLE_WAIT = chrono::milliseconds(20);
+
+Logger::Logger(size_t capacity) : slots(new Slot[capacity]), mask(capacity - 1)
+{
+    for (size_t i = 0; i < capacity; i++)
+    {
+        slots[i].sequence.store(i, memory_order_relaxed);
+    }
+}
+
+Logger &Logger::instance()
+{
+    static Logger logger(CAPACITY);
+    return logger;
+}
+
+void Logger::log(LogLevel level, const string &node, const string &message)
+{
+    // Bounded MPMC ring (Vyukov): a slot is free for position p when its sequence equals p
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    Slot *slot;
+    while (true)
+    {
+        slot = &slots[pos & mask];
+        size_t sequence = slot->sequence.load(memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            dropped.fetch_add(1, memory_order_relaxed); // Full; the writer is behind
+            return;
+        }
+        else
+        {
+            pos = enqueuePos.load(memory_order_relaxed);
+        }
+    }
+
+    slot->timestamp = chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+    slot->level = level;
+    slot->node = node;
+    slot->message = message;
+    slot->sequence.store(pos + 1, memory_order_release);
+}
+
+size_t Logger::drain(string &batch)
+{
+    size_t count = 0;
+    while (count < MAX_BATCH)
+    {
+        Slot &slot = slots[dequeuePos & mask];
+        if (slot.sequence.load(memory_order_acquire) != dequeuePos + 1)
+        {
+            break; // Empty, or the producer of this slot has not finished writing it
+        }
+
+        json entry = {
+            {"timestamp", slot.timestamp},
+            {"level", levelName(slot.level)},
+            {"node", move(slot.node)},
+            {"message", move(slot.message)}};
+        batch += entry.dump(-1, ' ', false, json::error_handler_t::replace);
+        batch += '\n';
+
+        slot.sequence.store(dequeuePos + mask + 1, memory_order_release);
+        dequeuePos++;
+        count++;
+    }
+    return count;
+}
+
+void Logger::writerLoop()
+{
+    ofstream out(path, ios::app);
+    string batch;
+    while (true)
+    {
+        bool stopping = !running.load();
+        batch.clear();
+        size_t count = drain(batch);
+        if (count > 0)
+        {
+            out.write(batch.data(), batch.size());
+            out.flush();
+            written.fetch_add(count, memory_order_relaxed);
+            batches.fetch_add(1, memory_order_relaxed);
+            continue;
+        }
+        if (stopping)
+        {
+            return;
+        }
+        this_thread::sleep_for(IDLE_WAIT);
+    }
+}
+
+void Logger::start(const string &path)
+{
+    lock_guard<mutex> lock(mtxWriter);
+    if (running)
+    {
+        return;
+    }
+    this->path = path;
+    running = true;
+    writer = thread(&Logger::writerLoop, this);
+}
+
+void Logger::stop()
+{
+    lock_guard<mutex> lock(mtxWriter);
+    if (!running)
+    {
+        return;
+    }
+    running = false;
+    writer.join();
+}
+
+void Logger::setDefaultLevel(LogLevel level)
+{
+    defaultLevel = level;
+}
+
+void Logger::setNodeLevel(const string &node, LogLevel level)
+{
+    lock_guard<mutex> lock(mtxLevels);
+    nodeLevels[node] = level;
+}
+
+LogLevel Logger::levelFor(const string &node) const
+{
+    lock_guard<mutex> lock(mtxLevels);
+    auto found = nodeLevels.find(node);
+    return found != nodeLevels.end() ? found->second : defaultLevel.load();
+}
+
+LoggerStats Logger::stats() const
+{
+    LoggerStats out;
+    out.written = written.load();
+    out.dropped = dropped.load();
+    out.batches = batches.load();
+    return out;
+}
+
+LogLevel Logger::parseLevel(const string &name)
+{
+    if (name == "debug")
+        return LogLevel::Debug;
+    if (name == "info")
+        return LogLevel::Info;
+    if (name == "warn")
+        return LogLevel::Warn;
+    if (name == "error")
+        return LogLevel::Error;
+    if (name == "off")
+        return LogLevel::Off;
+    throw runtime_error("Unknown log level: " + name);
+}
+
+const char *Logger::levelName(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Debug:
+        return "debug";
+    case LogLevel::Info:
+        return "info";
+    case LogLevel::Warn:
+        return "warn";
+    case LogLevel::Error:
+        return "error";
+    default:
+        return "off";
+    }
+}
+
+Logger::~Logger()
+{
+    stop();
+}
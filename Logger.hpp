@@ -0,0 +1,112 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+enum class LogLevel : uint8_t
+{
+    Debug = 0,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+// Entries below this level are removed at compile time, e.g. -DLOG_COMPILED_LEVEL=1 drops Debug
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL 0
+#endif
+
+// With nothing compiled out the gate is a constant, which keeps -Wtype-limits quiet
+#if LOG_COMPILED_LEVEL > 0
+#define LOG_COMPILED_IN(level) ((int)(level) >= LOG_COMPILED_LEVEL)
+#else
+#define LOG_COMPILED_IN(level) true
+#endif
+
+// Builds and enqueues `message` only if `level` passes both the compiled and the runtime
+// threshold, so a filtered call costs one comparison
+#define LOG_AT(level, threshold, node, message)                                   \
+    do                                                                            \
+    {                                                                             \
+        if (LOG_COMPILED_IN(level) && (level) >= (threshold))                     \
+        {                                                                         \
+            Logger::instance().log((level), (node), (message));                   \
+        }                                                                         \
+    } while (0)
+
+struct LoggerStats
+{
+    uint64_t written = 0; // Entries that reached the file
+    uint64_t dropped = 0; // Entries lost because the queue was full
+    uint64_t batches = 0; // Writes to the file, one flush each
+};
+
+// Process-wide asynchronous logger. log() claims a slot in a bounded ring with one atomic
+// compare-and-swap and never blocks; when the ring is full the entry is counted as dropped.
+// A single writer thread drains the ring and appends JSON Lines
+// ({"timestamp", "level", "node", "message"}) to the file, one write and flush per batch.
+class Logger
+{
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence{0};
+        double timestamp = 0;
+        LogLevel level = LogLevel::Info;
+        std::string node;
+        std::string message;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0; // Writer thread only
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> batches{0};
+
+    std::atomic<LogLevel> defaultLevel{LogLevel::Info};
+    mutable std::mutex mtxLevels;
+    std::unordered_map<std::string, LogLevel> nodeLevels;
+
+    std::mutex mtxWriter;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::string path;
+
+    explicit Logger(size_t capacity);
+    void writerLoop();
+    size_t drain(std::string &batch);
+
+public:
+    static const size_t CAPACITY = 8192; // Entries; a power of two
+
+    static Logger &instance();
+
+    // Appends to `path`; entries logged before start() wait in the ring
+    void start(const std::string &path);
+    // Writes out what is queued and stops the writer
+    void stop();
+
+    void log(LogLevel level, const std::string &node, const std::string &message);
+
+    void setDefaultLevel(LogLevel level);
+    void setNodeLevel(const std::string &node, LogLevel level);
+    // Nodes read their level once when they start
+    LogLevel levelFor(const std::string &node) const;
+    LoggerStats stats() const;
+
+    static LogLevel parseLevel(const std::string &name);
+    static const char *levelName(LogLevel level);
+
+    ~Logger();
+};
+
+#endif
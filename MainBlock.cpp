@@ -1,47 +1,88 @@
 #include "MainBlock.hpp"
-#include <sstream>
-#include <iomanip>
-#include <openssl/sha.h>
+#include <ctime>
+#include <stdexcept>
 
-MainBlock::MainBlock(int idx, std::string prevHash, std::vector<Game> games)
+MainBlock::MainBlock(int idx, const Hash256 &prevHash, std::vector<Game> games)
 {
     this->index = idx;
     this->previousHash = prevHash;
     this->games = games;
     this->timestamp = time(nullptr);
     this->nonce = 0;
+    computeMerkleRoot();
     this->hash = calculateHash();
-    this->difficulty = 3; // Default difficulty
+    this->difficulty = 0; // Set to the required difficulty when mined
 }
 
-std::string MainBlock::calculateHash()
+Hash256 MainBlock::calculateHash()
 {
-    std::stringstream ss;
-    ss << index << previousHash << timestamp << nonce;
+    return calculateHash(nonce);
+}
+
+std::vector<Sha256::Digest> MainBlock::leafHashes() const
+{
+    std::vector<Sha256::Digest> leaves;
+    leaves.reserve(games.size());
     for (const auto &tx : games)
     {
-        ss << tx.toString();
+        leaves.push_back(Merkle::leafHash(tx.digest()));
     }
-    std::string input = ss.str();
+    return leaves;
+}
+
+void MainBlock::computeMerkleRoot()
+{
+    merkleRoot = Merkle::root(leafHashes());
+}
 
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256(reinterpret_cast<const unsigned char *>(input.c_str()), input.size(), hash);
+bool MainBlock::merkleRootMatches() const
+{
+    return Merkle::root(leafHashes()) == merkleRoot;
+}
 
-    std::stringstream hashString;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i)
+MerkleProof MainBlock::proveGame(int gameId) const
+{
+    for (size_t i = 0; i < games.size(); i++)
     {
-        hashString << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+        if (games[i].gameId == gameId)
+        {
+            return Merkle::prove(leafHashes(), i);
+        }
     }
+    throw std::runtime_error("Game " + std::to_string(gameId) + " is not in block " + std::to_string(index));
+}
 
-    return hashString.str();
+bool MainBlock::verifyGameProof(const Game &game, const MerkleProof &proof, const BlockHeader &header)
+{
+    return Merkle::verify(Merkle::leafHash(game.digest()), proof, header.merkleRoot);
+}
+
+BlockHeader MainBlock::header(int nonce) const
+{
+    BlockHeader header;
+    header.index = index;
+    header.previousHash = previousHash;
+    header.timestamp = timestamp;
+    header.merkleRoot = merkleRoot;
+    header.nonce = nonce;
+    return header;
 }
 
-void MainBlock::mineBlock(int difficulty)
+Hash256 MainBlock::calculateHash(int nonce) const
 {
-    std::string target(difficulty, '0');
-    do
+    return header(nonce).hash();
+}
+
+MiningResult MainBlock::mineBlock(int difficulty, const MiningJob *job, unsigned int threads)
+{
+    this->difficulty = difficulty;
+    HeaderHasher hasher(header(nonce));
+    Miner miner(threads);
+    MiningResult result = miner.mine(hasher, difficulty, nonce + 1, job);
+    if (result.found)
     {
-        nonce++;
-        hash = calculateHash();
-    } while (hash.substr(0, difficulty) != target);
+        nonce = result.nonce;
+        hash = result.hash;
+    }
+    return result;
 }
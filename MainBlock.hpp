@@ -4,22 +4,35 @@
 #include <string>
 #include <vector>
 #include "Game.hpp"
+#include "Miner.hpp"
+#include "BlockHeader.hpp"
+#include "Merkle.hpp"
 
 class MainBlock
 {
 public:
     int index;
-    std::string previousHash;
+    Hash256 previousHash;
     std::vector<Game> games;
     long timestamp;
     int nonce;
-    std::string hash;
-    int difficulty;
+    Hash256 hash;
+    int difficulty; // Leading zero bits of hash
+    Sha256::Digest merkleRoot; // Commits to games; computed once per block template
 
-    MainBlock(int idx, std::string prevHash, std::vector<Game> games);
+    MainBlock(int idx, const Hash256 &prevHash, std::vector<Game> games);
 
-    std::string calculateHash();
-    void mineBlock(int difficulty);
+    std::vector<Sha256::Digest> leafHashes() const;
+    void computeMerkleRoot();
+    // False if merkleRoot no longer commits to the games the block carries
+    bool merkleRootMatches() const;
+    BlockHeader header(int nonce) const;
+    Hash256 calculateHash();
+    Hash256 calculateHash(int nonce) const;
+    // Inclusion proof for one of this block's games, checkable against the header alone
+    MerkleProof proveGame(int gameId) const;
+    static bool verifyGameProof(const Game &game, const MerkleProof &proof, const BlockHeader &header);
+    MiningResult mineBlock(int difficulty, const MiningJob *job = nullptr, unsigned int threads = 0);
 };
 
 #endif
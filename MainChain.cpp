@@ -3,18 +3,28 @@
 #include <stdexcept>
 #include <string>
 #include <fstream>
+#include <algorithm>
 
 using namespace std;
 
-MainChain::MainChain()
+// Passed by reference to min/max, so they need a definition
+const int MainChain::MIN_DIFFICULTY;
+const int MainChain::MAX_DIFFICULTY;
+const size_t MainChain::RETARGET_WINDOW;
+const size_t MainChain::RATING_SNAPSHOT_INTERVAL;
+
+MainChain::MainChain(int initialDifficulty, long targetBlockTime)
 {
+    this->initialDifficulty = initialDifficulty;
+    this->targetBlockTime = targetBlockTime;
+
     // Add the genesis block
     chain.push_back(createGenesisBlock());
 }
 
 MainBlock MainChain::createGenesisBlock()
 {
-    return MainBlock(0, "0", vector<Game>());
+    return MainBlock(0, Hash256{}, vector<Game>());
 }
 
 void MainChain::updateRating(const MainBlock &block)
@@ -37,10 +47,78 @@ void MainChain::updateRating(const MainBlock &block)
     }
 }
 
+RatingSnapshot MainChain::captureRatings(size_t height) const
+{
+    RatingSnapshot ratings;
+    ratings.height = height;
+    ratings.tip = chain[height - 1].hash;
+    ratings.ratings.assign(rating.begin(), rating.end());
+    sort(ratings.ratings.begin(), ratings.ratings.end(), [](const pair<Address, double> &a, const pair<Address, double> &b)
+         { return a.first < b.first; });
+    return ratings;
+}
+
+size_t MainChain::replayRatings(size_t fromHeight)
+{
+    for (size_t height = fromHeight; height < chain.size(); height++)
+    {
+        updateRating(chain[height]);
+        if ((height + 1) % RATING_SNAPSHOT_INTERVAL == 0)
+        {
+            snapshot = captureRatings(height + 1);
+        }
+    }
+    return chain.size() - fromHeight;
+}
+
 void MainChain::addBlock(MainBlock newBlock)
 {
     updateRating(newBlock); // Update balances before adding the block
     chain.push_back(newBlock);
+    if (chain.size() % RATING_SNAPSHOT_INTERVAL == 0)
+    {
+        snapshot = captureRatings(chain.size());
+    }
+}
+
+void MainChain::restoreGenesis(const MainBlock &genesis)
+{
+    chain.clear();
+    rating.clear();
+    snapshot = RatingSnapshot();
+    chain.push_back(genesis);
+}
+
+void MainChain::addBlockUnrated(MainBlock newBlock)
+{
+    chain.push_back(newBlock);
+}
+
+size_t MainChain::restoreRatings(const RatingSnapshot &ratings)
+{
+    rating.clear();
+    snapshot = RatingSnapshot();
+    size_t from = 0;
+    if (!ratings.empty() && ratings.height <= chain.size() && chain[ratings.height - 1].hash == ratings.tip)
+    {
+        rating.insert(ratings.ratings.begin(), ratings.ratings.end());
+        snapshot = ratings;
+        from = ratings.height;
+    }
+    return replayRatings(from);
+}
+
+size_t MainChain::adopt(const MainChain &other)
+{
+    initialDifficulty = other.initialDifficulty;
+    targetBlockTime = other.targetBlockTime;
+    chain = other.chain;
+    return restoreRatings(other.snapshot);
+}
+
+const RatingSnapshot &MainChain::ratingSnapshot() const
+{
+    return snapshot;
 }
 
 MainBlock MainChain::getLastBlock()
@@ -57,7 +135,61 @@ vector<MainBlock> MainChain::getChain()
     return chain;
 }
 
-double MainChain::getRating(const string &address)
+MainBlock MainChain::getBlock(size_t height) const
+{
+    return chain.at(height);
+}
+
+bool MainChain::containsBlock(const Hash256 &hash) const
+{
+    for (const auto &block : chain)
+    {
+        if (block.hash == hash)
+            return true;
+    }
+    return false;
+}
+
+size_t MainChain::size() const
+{
+    return chain.size();
+}
+
+int MainChain::requiredDifficulty(size_t height) const
+{
+    if (height == 0)
+    {
+        return 0; // Genesis is not mined
+    }
+    if (height > chain.size())
+    {
+        return initialDifficulty;
+    }
+
+    // Replayed from the first mined block, because a block's difficulty field is outside
+    // the hashed header and a peer could put anything there. At each height the most
+    // recent intervals between mined blocks are averaged (the genesis timestamp is just
+    // when the chain was created), and the difficulty moves one bit, i.e. 2x the work,
+    // when the average leaves [target / 2, target * 2].
+    int difficulty = initialDifficulty;
+    for (size_t next = 2; next <= height; next++)
+    {
+        size_t intervals = min(RETARGET_WINDOW, next - 2);
+        if (intervals == 0)
+        {
+            continue;
+        }
+        long span = chain[next - 1].timestamp - chain[next - 1 - intervals].timestamp;
+        if (span * 2 < targetBlockTime * (long)intervals)
+            difficulty++;
+        else if (span > targetBlockTime * 2 * (long)intervals)
+            difficulty--;
+        difficulty = max(MIN_DIFFICULTY, min(MAX_DIFFICULTY, difficulty));
+    }
+    return difficulty;
+}
+
+double MainChain::getRating(const Address &address)
 {
     if (rating.find(address) == rating.end())
     {
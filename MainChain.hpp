@@ -6,6 +6,7 @@
 #include <string>
 #include "MainBlock.hpp"
 #include "Game.hpp"
+#include "RatingSnapshot.hpp"
 
 using namespace std;
 
@@ -13,18 +14,47 @@ class MainChain
 {
 private:
     vector<MainBlock> chain;              // Ordered chain
-    unordered_map<string, double> rating; // Hash map to maintain balances
+    unordered_map<Address, double> rating; // Rating per player address
+    int initialDifficulty;                // Leading zero bits required of the first mined block
+    long targetBlockTime;                 // Seconds between blocks that retargeting aims for
+    RatingSnapshot snapshot;              // Newest periodic rating snapshot
 
     MainBlock createGenesisBlock();
     void updateRating(const MainBlock &block);
+    RatingSnapshot captureRatings(size_t height) const;
+    size_t replayRatings(size_t fromHeight);
 
 public:
-    MainChain();
+    static const int DEFAULT_DIFFICULTY = 20;
+    static const long DEFAULT_BLOCK_TIME = 10;
+    static const int MIN_DIFFICULTY = 8;
+    static const int MAX_DIFFICULTY = 31; // The miner's nonce range holds 2^31 values
+    static const size_t RETARGET_WINDOW = 5; // Block intervals averaged per retarget
+    static const size_t RATING_SNAPSHOT_INTERVAL = 16; // Blocks between rating snapshots
+
+    MainChain(int initialDifficulty = DEFAULT_DIFFICULTY, long targetBlockTime = DEFAULT_BLOCK_TIME);
 
     void addBlock(MainBlock newGame);
+    // Drops every block and starts again from a persisted genesis block
+    void restoreGenesis(const MainBlock &genesis);
+    // Appends without rating the block; restoreRatings() has to follow
+    void addBlockUnrated(MainBlock newBlock);
+    // Takes ratings from `ratings` if it belongs to this chain and replays only the blocks after
+    // it, otherwise replays every block. Returns the number of blocks replayed
+    size_t restoreRatings(const RatingSnapshot &ratings);
+    // Takes over another chain's blocks, with ratings from its newest snapshot
+    size_t adopt(const MainChain &other);
+    const RatingSnapshot &ratingSnapshot() const;
     MainBlock getLastBlock();
     vector<MainBlock> getChain();
-    double getRating(const string &address);
+    // Single block by height without copying the chain; throws out_of_range
+    MainBlock getBlock(size_t height) const;
+    bool containsBlock(const Hash256 &hash) const;
+    size_t size() const;
+    // Leading zero bits a block at `height` must meet, derived from the timestamps of the
+    // blocks before it; their own difficulty fields are never consulted
+    int requiredDifficulty(size_t height) const;
+    double getRating(const Address &address);
 };
 
 #endif
@@ -1,4 +1,7 @@
 #include "MainNode.hpp"
+#include "BatchVerifier.hpp"
+#include "ChainCodec.hpp"
+#include "DurableWriter.hpp"
 #include <fstream>
 #include <algorithm>
 #include <nlohmann/json.hpp>
@@ -6,87 +9,24 @@
 using namespace std;
 using json = nlohmann::json;
 
-MainNode::MainNode(MainChain &bc, int diff) : blockchain(bc), difficulty(diff)
-{
-    nodeId = 1000000000 + rand() % 9000000000;
-    logMessage("Node " + to_string(nodeId) + " started");
-
-    // Initialize {nodeId}_mempool.json with an empty array
-    string mempoolFilename = "./data/" + to_string(nodeId) + "_mainMempool.json";
-    ifstream mempoolCheckFile(mempoolFilename);
-    ofstream mempoolInitFile(mempoolFilename);
-    if (mempoolInitFile.is_open())
-    {
-        mempoolInitFile << "[]"; // Initialize with an empty array
-        mempoolInitFile.close();
-    }
-    // Initialize {nodeId}_blockchain.json with an empty array
-    string blockchainFilename = "./data/" + to_string(nodeId) + "_mainBlockchain.json";
-    ifstream blockchainCheckFile(blockchainFilename);
-    ofstream blockchainInitFile(blockchainFilename);
-    if (blockchainInitFile.is_open())
-    {
-        blockchainInitFile << "[]"; // Initialize with an empty array
-        blockchainInitFile.close();
-    }
-
-    // Add the genesis block to {nodeId}_blockchain.json
-    string filename = "./data/" + to_string(nodeId) + "_mainBlockchain.json";
-    ifstream checkFile(filename);
-    if (checkFile.peek() == ifstream::traits_type::eof())
-    {
-        ofstream initFile(filename);
-        if (initFile.is_open())
-        {
-            initFile << "[]"; // Initialize with an empty array
-            initFile.close();
-        }
-    }
-
-    json blockchainJson = json::array();
-    ifstream inputFile(filename);
-    if (inputFile.is_open())
-    {
-        try
-        {
-            inputFile >> blockchainJson;
-        }
-        catch (const json::parse_error &e)
-        {
-            cerr << "Error parsing JSON 1: " << e.what() << endl;
-        }
-        inputFile.close();
-    }
-
-    MainBlock genesisBlock = blockchain.getChain().front();
-    json blockJson = {
-        {"index", genesisBlock.index},
-        {"previousHash", genesisBlock.previousHash},
-        {"hash", genesisBlock.hash},
-        {"timestamp", genesisBlock.timestamp},
-        {"games", json::array()},
-        {"nonce", genesisBlock.nonce}};
-
-    for (const auto &txn : genesisBlock.games)
-    {
-        blockJson["games"].push_back(txn.toString());
-    }
-
-    blockchainJson.push_back(blockJson);
+// The message expression is only evaluated when this node's level lets it through
+#define NODE_LOG(level, message) LOG_AT(level, logLevel, to_string(nodeId), message)
 
-    ofstream outputFile(filename, ios::trunc);
-    if (!outputFile.is_open())
-    {
-        throw runtime_error("Failed to open " + filename + " for writing.");
-    }
+MainNode::MainNode(MainChain &bc, int requestedId) : blockchain(bc)
+{
+    nodeId = requestedId != 0 ? requestedId : 1000000000 + rand() % 9000000000;
+    logLevel = Logger::instance().levelFor(to_string(nodeId));
+    NODE_LOG(LogLevel::Info, "Node " + to_string(nodeId) + " started");
 
-    outputFile << blockchainJson.dump(4); // Pretty print with 4 spaces
-    outputFile.close();
+    openMempool();
+    openBlockLog();
 }
 
-MainNode::MainNode(vector<MainNode *> peers, int diff) : blockchain(*(new MainChain())), difficulty(diff) // Initialize with an empty blockchain
-{                                                                                                         // Initialize with a dummy address
-    nodeId = 1000000000 + rand() % 9000000000;
+MainNode::MainNode(vector<MainNode *> peers, int requestedId) : blockchain(*(new MainChain())) // Initialize with an empty blockchain
+{                                                                                        // Initialize with a dummy address
+    nodeId = requestedId != 0 ? requestedId : 1000000000 + rand() % 9000000000;
+    logLevel = Logger::instance().levelFor(to_string(nodeId));
+    openMempool();
     if (peers.empty())
     {
         throw runtime_error("No peers connected.");
@@ -100,123 +40,14 @@ MainNode::MainNode(vector<MainNode *> peers, int diff) : blockchain(*(new MainCh
         }
         else
         {
-            logMessage("Peer " + to_string(peer->nodeId) + " is not running. Skipping connection.");
+            NODE_LOG(LogLevel::Warn, "Peer " + to_string(peer->nodeId) + " is not running. Skipping connection.");
         }
     }
 
-    logMessage("Node " + to_string(nodeId) + " started");
-
-    // Initialize {nodeId}_mempool.json with an empty array
-    string mempoolFilename = "./data/" + to_string(nodeId) + "_mainMempool.json";
-    ifstream mempoolCheckFile(mempoolFilename);
-    ofstream mempoolInitFile(mempoolFilename);
-    if (mempoolInitFile.is_open())
-    {
-        mempoolInitFile << "[]"; // Initialize with an empty array
-        mempoolInitFile.close();
-    }
-    // Initialize {nodeId}_blockchain.json with an empty array
-    string blockchainFilename = "./data/" + to_string(nodeId) + "_mainBlockchain.json";
-    ifstream blockchainCheckFile(blockchainFilename);
-    ofstream blockchainInitFile(blockchainFilename);
-    if (blockchainInitFile.is_open())
-    {
-        blockchainInitFile << "[]"; // Initialize with an empty array
-        blockchainInitFile.close();
-    }
+    NODE_LOG(LogLevel::Info, "Node " + to_string(nodeId) + " started");
 
     syncPeers();
-
-    // Save the blockchain to {nodeId}_blockchain.json
-    json blockchainJson = json::array();
-
-    for (const auto &block : blockchain.getChain())
-    {
-        json blockJson = {
-            {"index", block.index},
-            {"previousHash", block.previousHash},
-            {"hash", block.hash},
-            {"timestamp", block.timestamp},
-            {"games", json::array()},
-            {"nonce", block.nonce}};
-
-        for (const auto &txn : block.games)
-        {
-            blockJson["games"].push_back(txn.toString());
-        }
-
-        blockchainJson.push_back(blockJson);
-    }
-
-    ofstream blockchainOutFile(blockchainFilename, ios::trunc);
-    if (blockchainOutFile.is_open())
-    {
-        blockchainOutFile << blockchainJson.dump(4); // Pretty print with 4 spaces
-        blockchainOutFile.close();
-    }
-
-    // Save the transactionQueue to {nodeId}_mempool.json
-    json mempoolJson = json::array();
-    {
-        lock_guard<mutex> lock(mtx);
-        queue<Game> tempQueue = transactionQueue;
-
-        while (!tempQueue.empty())
-        {
-            const auto &txn = tempQueue.front();
-            mempoolJson.push_back(txn.toString());
-            tempQueue.pop();
-        }
-    }
-
-    ofstream mempoolOutFile(mempoolFilename, ios::trunc);
-    if (mempoolOutFile.is_open())
-    {
-        mempoolOutFile << mempoolJson.dump(4); // Pretty print with 4 spaces
-        mempoolOutFile.close();
-    }
-}
-
-void MainNode::logMessage(const string &message)
-{
-    ifstream inputFile("logs.json");
-    json logs = json::array();
-
-    // cout << "Logging message: " << message << endl;
-
-    // Read existing logs from the file
-
-    if (inputFile.is_open())
-    {
-        try
-        {
-            inputFile >> logs;
-        }
-        catch (const json::parse_error &e)
-        {
-            cerr << "Error parsing JSON 2: " << e.what() << endl;
-        }
-        inputFile.close();
-    }
-
-    // Add the new log entry
-    json logEntry = {
-        {"timestamp", chrono::duration_cast<chrono::seconds>(
-                          chrono::system_clock::now().time_since_epoch())
-                          .count()},
-        {"message", message}};
-    logs.push_back(logEntry);
-
-    // Write back to the file
-    ofstream outputFile("logs.json", ios::trunc);
-    if (!outputFile.is_open())
-    {
-        throw runtime_error("Failed to open createdTransaction.json for writing.");
-    }
-
-    outputFile << logs.dump(4); // Pretty print with 4 spaces
-
-    outputFile.close();
+    openBlockLog();
 }
 
 bool MainNode::isValidTransaction(const Game &txn)
@@ -237,7 +68,7 @@ bool MainNode::isValidTransaction(const Game &txn)
         cout << "here3" << endl;
         return false;
     }
-    if (txn.winnerId == "")
+    if (txn.winnerId.isZero())
     {
         cout << "here4" << endl;
         return false;
@@ -271,18 +102,54 @@ void MainNode::mineBlock()
             if (transactions.empty())
                 continue;
 
-            logMessage("Mining Main block with " + to_string(transactions.size()) +
+            NODE_LOG(LogLevel::Info, "Mining Main block with " + to_string(transactions.size()) +
                        " transactions by Node " + to_string(nodeId));
 
-            MainBlock newBlock(blockchain.getChain().size(), blockchain.getLastBlock().hash, transactions);
-            newBlock.mineBlock(difficulty);
+            // Register the job before reading the tip so a block accepted in between still cancels it
+            auto job = make_shared<MiningJob>();
+            {
+                lock_guard<mutex> lock(mtxJob);
+                currentJob = job;
+            }
+            MainBlock newBlock(blockchain.size(), blockchain.getLastBlock().hash, transactions);
+            int required = blockchain.requiredDifficulty(newBlock.index);
+            MiningResult mined = newBlock.mineBlock(required, job.get());
+            uint64_t searched = mined.hashes;
+            // Running out of nonces is not a stale tip; a new timestamp gives a fresh header to search
+            while (!mined.found && !mined.cancelled && running)
+            {
+                NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " exhausted the nonce range at height " +
+                           to_string(newBlock.index) + ", retrying with a new timestamp");
+                newBlock.timestamp = max(newBlock.timestamp + 1, (long)time(nullptr));
+                mined = newBlock.mineBlock(required, job.get());
+                searched += mined.hashes;
+            }
+            {
+                lock_guard<mutex> lock(mtxJob);
+                currentJob.reset();
+            }
+            NODE_LOG(LogLevel::Debug, "Node " + to_string(nodeId) + " searched " + to_string(mined.hashes) + " nonces in " +
+                       to_string(mined.seconds) + "s (" + to_string((long long)mined.hashesPerSecond()) + " H/s)");
+
+            if (!mined.found)
+            {
+                if (!mined.cancelled)
+                {
+                    continue; // Shutting down
+                }
+                wastedHashes += searched;
+                requeueDisplaced(transactions, newBlock.index);
+                NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " abandoned stale block at height " + to_string(newBlock.index) +
+                           ", wasted hashes so far: " + to_string(wastedHashes));
+                continue;
+            }
 
             if (verifyNewBlock(newBlock))
             {
                 blockchain.addBlock(newBlock);
                 broadcastBlock(newBlock, 0);
                 cout << "aaaaaaaaaaaaaaaaaaaaaaaaaaa";
-                logMessage("Valid block mined by Node " + to_string(nodeId) + ": " + newBlock.hash);
+                NODE_LOG(LogLevel::Info, "Valid block mined by Node " + to_string(nodeId) + ": " + newBlock.hash.toHex());
 
                 // Update blockchain and mempool files
                 updateBlockchainFile(newBlock);
@@ -290,103 +157,246 @@ void MainNode::mineBlock()
             }
             else
             {
-                logMessage("Invalid block mined by Node " + to_string(nodeId));
+                // Usually the tip moved after the nonce was found
+                wastedHashes += searched;
+                requeueDisplaced(transactions, newBlock.index);
+                NODE_LOG(LogLevel::Warn, "Invalid block mined by Node " + to_string(nodeId));
             }
 
             this_thread::sleep_for(chrono::seconds(1)); // Prevent tight loop
         }
         catch (const exception &e)
         {
-            logMessage("Error in mining by Node " + to_string(nodeId) + ": " + e.what());
+            NODE_LOG(LogLevel::Error, "Error in mining by Node " + to_string(nodeId) + ": " + e.what());
         }
     }
 }
 
-void MainNode::updateBlockchainFile(const MainBlock &block)
+void MainNode::cancelMining()
 {
-    string filename = "./data/" + to_string(nodeId) + "_mainBlockchain.json";
-    json blockchainJson = json::array();
+    lock_guard<mutex> lock(mtxJob);
+    if (currentJob)
+    {
+        currentJob->cancel();
+    }
+}
 
-    ifstream inFile(filename);
-    if (inFile.is_open())
+void MainNode::requeueDisplaced(const vector<Game> &games, size_t fromHeight)
+{
+    // Games a competing block already included are dropped, the rest go back into the mempool
+    vector<MainBlock> competing;
+    for (size_t i = fromHeight; i < blockchain.size(); i++)
+    {
+        competing.push_back(blockchain.getBlock(i));
+    }
+    {
+        lock_guard<mutex> lock(mtx);
+        for (const auto &txn : games)
+        {
+            bool included = false;
+            for (size_t i = 0; i < competing.size() && !included; i++)
+            {
+                for (const auto &blockTxn : competing[i].games)
+                {
+                    if (txn.digest() == blockTxn.digest())
+                    {
+                        included = true;
+                        break;
+                    }
+                }
+            }
+            if (!included)
+            {
+                transactionQueue.push(txn);
+            }
+        }
+    }
+    cv.notify_all();
+}
+
+void MainNode::openBlockLog()
+{
+    blockLog.reset(new BlockLog("./data/" + to_string(nodeId) + "_mainBlockchain"));
+    if (blockLog->size() > 0)
+    {
+        recoverChain(); // Only when ./data was kept from an earlier run
+    }
+    // Keep a log that already holds this chain, rewrite it otherwise
+    if (blockLog->size() != blockchain.size() || blockLog->read(blockchain.size() - 1).hash != blockchain.getLastBlock().hash)
+    {
+        blockLog->reset(blockchain.getChain());
+    }
+    saveRatingSnapshot();
+}
+
+void MainNode::recoverChain()
+{
+    vector<MainBlock> logged;
+    vector<Hash256> hashes;
+    for (size_t height = 0; height < blockLog->size(); height++)
     {
         try
         {
-            inFile >> blockchainJson;
+            logged.push_back(blockLog->read(height));
         }
-        catch (const json::parse_error &e)
+        catch (const exception &e)
         {
-            cerr << "Error parsing JSON: " << e.what() << endl;
+            NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " cannot decode logged block " + to_string(height) + ": " + e.what());
+            break; // Treated like a torn tail: it and everything after it are dropped
         }
-        inFile.close();
+        hashes.push_back(logged.back().hash);
+    }
+    if (logged.empty())
+    {
+        return;
+    }
+    size_t trusted = 0;
+    try
+    {
+        const CheckpointEntry *entry = Checkpoint::load().find(to_string(nodeId));
+        trusted = entry ? entry->trustedHeight(hashes) : 0;
+    }
+    catch (const exception &e)
+    {
+        NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " ignoring checkpoint: " + e.what());
     }
 
-    json blockJson = {
-        {"index", block.index},
-        {"previousHash", block.previousHash},
-        {"hash", block.hash},
-        {"timestamp", block.timestamp},
-        {"games", json::array()},
-        {"nonce", block.nonce}};
-    for (const auto &txn : block.games)
+    // Whichever snapshot is newer, ours or the one adopted from a peer; a stale one is rejected by restoreRatings()
+    RatingSnapshot ratings = loadRatingSnapshot();
+    if (blockchain.ratingSnapshot().height > ratings.height)
+    {
+        ratings = blockchain.ratingSnapshot();
+    }
+
+    if (blockchain.size() == 1)
     {
-        blockJson["games"].push_back(txn.toString());
+        blockchain.restoreGenesis(logged[0]); // Nothing adopted from peers, so the log's chain is the chain
+    }
+    else if (logged.size() <= blockchain.size() || logged[blockchain.size() - 1].hash != blockchain.getLastBlock().hash)
+    {
+        return; // The log does not extend what peers gave us; it is rewritten from the chain
     }
-    blockchainJson.push_back(blockJson);
 
-    ofstream outFile(filename, ios::trunc);
-    if (outFile.is_open())
+    for (size_t height = blockchain.size(); height < logged.size(); height++)
     {
-        outFile << blockchainJson.dump(4);
-        outFile.close();
+        const MainBlock &block = logged[height];
+        bool valid;
+        if (height < trusted)
+        {
+            valid = block.previousHash == blockchain.getLastBlock().hash;
+        }
+        else
+        {
+            valid = verifyNewBlock(block);
+            for (size_t i = 0; valid && i < block.games.size(); i++)
+            {
+                valid = verifyValidGame(block.games[i]);
+            }
+        }
+        if (!valid)
+        {
+            NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " dropped " + to_string(logged.size() - height) +
+                       " logged blocks from height " + to_string(height) + " that failed validation");
+            logged.erase(logged.begin() + height, logged.end());
+            break;
+        }
+        blockchain.addBlockUnrated(block);
+        (height < trusted ? recovery.trustedBlocks : recovery.verifiedBlocks)++;
     }
+    recovery.droppedBlocks = blockLog->size() - logged.size();
+    recovery.ratingReplays = blockchain.restoreRatings(ratings);
+    NODE_LOG(LogLevel::Info, "Node " + to_string(nodeId) + " recovered " + to_string(blockchain.size()) + " blocks (" +
+               to_string(recovery.trustedBlocks) + " trusted from checkpoint, " + to_string(recovery.verifiedBlocks) + " verified)");
 }
 
-void MainNode::updateMempoolFile(const vector<Game> &transactions)
+RatingSnapshot MainNode::loadRatingSnapshot()
 {
-    string filename = "./data/" + to_string(nodeId) + "_mainMempool.json";
-    json mempool = json::array();
+    ifstream in("./data/" + to_string(nodeId) + "_ratings.snap", ios::binary);
+    if (!in.is_open())
+    {
+        return RatingSnapshot();
+    }
+    try
+    {
+        return RatingSnapshot::decode(string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>()));
+    }
+    catch (const exception &e)
+    {
+        NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " ignoring rating snapshot: " + e.what());
+        return RatingSnapshot();
+    }
+}
 
-    ifstream inFile(filename);
-    if (inFile.is_open())
+void MainNode::saveRatingSnapshot()
+{
+    RatingSnapshot ratings = blockchain.ratingSnapshot();
+    if (ratings.empty() || ratings.height == savedRatingHeight)
+    {
+        return;
+    }
+    try
+    {
+        DurableWriter::instance().replace("./data/" + to_string(nodeId) + "_ratings.snap", ratings.encode(), FileClass::Blockchain);
+        savedRatingHeight = ratings.height;
+    }
+    catch (const exception &e)
+    {
+        NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " failed to save rating snapshot: " + e.what());
+    }
+}
+
+void MainNode::updateBlockchainFile(const MainBlock &block)
+{
+    if (!blockLog)
+    {
+        return; // Still constructing; openBlockLog() writes the whole chain
+    }
+    try
+    {
+        blockLog->append(block);
+    }
+    catch (const exception &e)
+    {
+        // Blocks from the miner and from peers can land out of order; rewrite from the chain
+        NODE_LOG(LogLevel::Warn, "Node " + to_string(nodeId) + " block log out of step (" + e.what() + "), rewriting it");
+        blockLog->reset(blockchain.getChain());
+    }
+    saveRatingSnapshot();
+}
+
+void MainNode::openMempool()
+{
+    mempool.reset(new MempoolJournal("./data/" + to_string(nodeId) + "_mainMempool"));
+    for (const auto &entry : mempool->contents())
     {
         try
         {
-            inFile >> mempool;
+            transactionQueue.push(ChainCodec::decodeGame(entry));
         }
-        catch (const json::parse_error &e)
+        catch (const exception &e)
         {
-            cerr << "Error parsing JSON: " << e.what() << endl;
+            NODE_LOG(LogLevel::Warn, "Dropped unreadable mempool entry on Node " + to_string(nodeId) + ": " + e.what());
         }
-        inFile.close();
     }
+    recovery.queuedTransactions = transactionQueue.size();
+}
 
+void MainNode::updateMempoolFile(const vector<Game> &transactions)
+{
+    vector<Hash256> digests;
+    digests.reserve(transactions.size());
     for (const auto &txn : transactions)
     {
-        mempool.erase(remove_if(mempool.begin(), mempool.end(),
-                                [&txn](const json &mempoolTxn)
-                                {
-                                    return mempoolTxn["gameId"] == txn.gameId &&
-                                           mempoolTxn["players"] == txn.players &&
-                                           mempoolTxn["winnerId"] == txn.winnerId &&
-                                           mempoolTxn["gameComplete"] == txn.gameComplete;
-                                }),
-                      mempool.end());
-    }
-
-    ofstream outFile(filename, ios::trunc);
-    if (outFile.is_open())
-    {
-        outFile << mempool.dump(4);
-        outFile.close();
+        digests.push_back(txn.digest());
     }
+    mempool->remove(digests);
 }
 
 void MainNode::connectPeer(MainNode *peer)
 {
     if (peer == this)
     {
-        logMessage("Cannot connect to self: Node " + to_string(nodeId));
+        NODE_LOG(LogLevel::Warn, "Cannot connect to self: Node " + to_string(nodeId));
         return;
     }
     if (find(peers.begin(), peers.end(), peer) == peers.end())
@@ -396,11 +406,11 @@ void MainNode::connectPeer(MainNode *peer)
         {
             peer->peers.push_back(this); // Ensure bidirectional connection
         }
-        logMessage("Node " + to_string(nodeId) + " connected to Node " + to_string(peer->nodeId));
+        NODE_LOG(LogLevel::Info, "Node " + to_string(nodeId) + " connected to Node " + to_string(peer->nodeId));
     }
     else
     {
-        logMessage("Node " + to_string(nodeId) + " is already connected to Node " + to_string(peer->nodeId));
+        NODE_LOG(LogLevel::Debug, "Node " + to_string(nodeId) + " is already connected to Node " + to_string(peer->nodeId));
     }
 }
 
@@ -408,7 +418,7 @@ void MainNode::broadcastTransaction(const Game &txn)
 {
     for (auto peer : peers)
     {
-        logMessage("Transaction broadcasted from Node " + to_string(nodeId) + " to Node " + to_string(peer->nodeId));
+        NODE_LOG(LogLevel::Debug, "Transaction broadcasted from Node " + to_string(nodeId) + " to Node " + to_string(peer->nodeId));
         peer->receiveTransaction(txn, this);
     }
 }
@@ -418,7 +428,7 @@ void MainNode::broadcastTransaction(const Game &txn, MainNode *speer)
     {
         if (speer->nodeId == peer->nodeId)
             continue;
-        logMessage("Transaction broadcasted from Node " + to_string(nodeId) + " to Node " + to_string(peer->nodeId));
+        NODE_LOG(LogLevel::Debug, "Transaction broadcasted from Node " + to_string(nodeId) + " to Node " + to_string(peer->nodeId));
         peer->receiveTransaction(txn, this);
     }
 }
@@ -438,21 +448,22 @@ bool MainNode::verifyValidGame(const Game &game)
             return false;
         }
 
-        // Check if the block's hash meets the difficulty criteria
-        string target(currentBlock.difficulty, '0');
-        if (currentBlock.hash.substr(0, currentBlock.difficulty) != target)
+        // Check the hash commits to the block and meets the difficulty the game chain requires at this height
+        if (!currentBlock.merkleRootMatches() || currentBlock.calculateHash(currentBlock.nonce) != currentBlock.hash ||
+            !Miner::meetsTarget(currentBlock.hash, game.requiredDifficulty(i)))
         {
             return false;
         }
+    }
 
-        // Verify the integrity of the block's transactions
-        for (const auto &txn : currentBlock.moves)
-        {
-            if (!txn.isValid())
-            {
-                return false;
-            }
-        }
+    // Verify every move signature in one batch, spread over the shared pool
+    BatchResult signatures = BatchVerifier().verify(game);
+    NODE_LOG(LogLevel::Debug, "Node " + to_string(nodeId) + " verified " + to_string(signatures.checked) + "/" +
+               to_string(signatures.total) + " signatures (" + to_string(signatures.cached) + " cached) of game " + to_string(game.gameId) + " in " +
+               to_string(signatures.seconds * 1000.0) + " ms on " + to_string(signatures.workers) + " threads");
+    if (!signatures.valid)
+    {
+        return false;
     }
 
     // Additional checks can be added here, such as verifying the game's winner or rules
@@ -466,13 +477,13 @@ void MainNode::syncPeers()
 
     MainChain *longestChain = &blockchain;
     MainNode *sourcePeer = nullptr;
-    size_t maxLength = blockchain.getChain().size();
+    size_t maxLength = blockchain.size();
 
     for (auto peer : peers)
     {
-        if (peer->blockchain.getChain().size() > maxLength && peer->running)
+        if (peer->blockchain.size() > maxLength && peer->running)
         {
-            maxLength = peer->blockchain.getChain().size();
+            maxLength = peer->blockchain.size();
             longestChain = &peer->blockchain;
             sourcePeer = peer;
         }
@@ -480,9 +491,11 @@ void MainNode::syncPeers()
 
     if (longestChain != &blockchain)
     {
-        blockchain = *longestChain; // Adopt the longest chain
-        logMessage("Node " + to_string(nodeId) + " synced blockchain with Node " +
-                   (sourcePeer ? to_string(sourcePeer->nodeId) : "unknown"));
+        // Adopt the longest chain; ratings come from its snapshot plus the blocks after it
+        size_t replayed = blockchain.adopt(*longestChain);
+        NODE_LOG(LogLevel::Info, "Node " + to_string(nodeId) + " synced blockchain with Node " +
+                   (sourcePeer ? to_string(sourcePeer->nodeId) : "unknown") + ", replayed ratings of " +
+                   to_string(replayed) + " blocks after the snapshot at height " + to_string(blockchain.ratingSnapshot().height));
     }
 
     // Sync transactions
@@ -493,12 +506,12 @@ void MainNode::syncPeers()
         queue<Game> tempQueue = peer->transactionQueue;
         while (!tempQueue.empty())
         {
-            auto &txn = tempQueue.front();
+            Game txn = tempQueue.front();
             tempQueue.pop();
             if (isValidTransaction(txn) && verifyValidGame(txn))
             {
                 addTransaction(txn);
-                logMessage("Transaction synced from Node " + to_string(peer->nodeId) +
+                NODE_LOG(LogLevel::Debug, "Transaction synced from Node " + to_string(peer->nodeId) +
                            " to Node " + to_string(nodeId));
             }
         }
@@ -513,7 +526,7 @@ void MainNode::broadcastBlock(const MainBlock &block, int peerId)
             if (peer->nodeId == peerId)
                 continue;
         peer->receiveBlock(block, this);
-        logMessage("Block" + block.hash + "broadcasted from Node " + to_string(nodeId) + " to Node " + to_string(peer->nodeId));
+        NODE_LOG(LogLevel::Debug, "Block" + block.hash.toHex() + "broadcasted from Node " + to_string(nodeId) + " to Node " + to_string(peer->nodeId));
     }
 }
 
@@ -526,25 +539,23 @@ void MainNode::receiveBlock(const MainBlock &block, MainNode *peer)
 {
     if (peer == nullptr)
     {
-        logMessage("Received block from NULL peer.");
+        NODE_LOG(LogLevel::Warn, "Received block from NULL peer.");
         return;
     }
 
     cout << "Received block from Node " << peer->nodeId << " me " << this->nodeId << endl;
     // Validate and add block if valid
-    for (const auto &existingBlock : blockchain.getChain())
+    if (blockchain.containsBlock(block.hash))
     {
-        if (existingBlock.hash == block.hash)
-        {
-            logMessage("Block already in blockchain, hash: " + block.hash + ", from Node " + to_string(peer->nodeId));
-            return;
-        }
+        NODE_LOG(LogLevel::Debug, "Block already in blockchain, hash: " + block.hash.toHex() + ", from Node " + to_string(peer->nodeId));
+        return;
     }
     cout << "Received block from Node " << peer->nodeId << verifyNewBlock(block) << endl;
     if (verifyNewBlock(block))
     {
         cout << "Valid block received from Node " << peer->nodeId << endl;
         blockchain.addBlock(block);
+        cancelMining(); // Whatever we were mining now builds on a stale tip
         broadcastBlock(block, peer->nodeId);
         // Remove transactions in the block from the transaction queue
         {
@@ -556,10 +567,7 @@ void MainNode::receiveBlock(const MainBlock &block, MainNode *peer)
                 bool found = false;
                 for (const auto &blockTxn : block.games)
                 {
-                    if (txn.gameId == blockTxn.gameId &&
-                        txn.players == blockTxn.players &&
-                        txn.winnerId == blockTxn.winnerId &&
-                        txn.gameComplete == blockTxn.gameComplete)
+                    if (txn.digest() == blockTxn.digest())
                     {
                         found = true;
                         break;
@@ -574,84 +582,8 @@ void MainNode::receiveBlock(const MainBlock &block, MainNode *peer)
             transactionQueue = move(tempQueue);
         }
 
-        // Remove transactions in the block from the mempool
-        string mempoolFilename = "./data/" + to_string(nodeId) + "_mainMempool.json";
-        json mempool = json::array();
-
-        ifstream mempoolInFile(mempoolFilename);
-        if (mempoolInFile.is_open())
-        {
-            try
-            {
-                mempoolInFile >> mempool;
-            }
-            catch (const json::parse_error &e)
-            {
-                cerr << "Error parsing JSON 4: " << e.what() << endl;
-            }
-            mempoolInFile.close();
-        }
-
-        for (const auto &txn : block.games)
-        {
-            auto it = remove_if(mempool.begin(), mempool.end(),
-                                [&txn](const json &mempoolTxn)
-                                {
-                                    return mempoolTxn["gameId"] == txn.gameId &&
-                                           mempoolTxn["players"] == txn.players &&
-                                           mempoolTxn["winnerId"] == txn.winnerId &&
-                                           mempoolTxn["gameComplete"] == txn.gameComplete;
-                                });
-            mempool.erase(it, mempool.end());
-        }
-
-        ofstream mempoolOutFile(mempoolFilename, ios::trunc);
-        if (mempoolOutFile.is_open())
-        {
-            mempoolOutFile << mempool.dump(4); // Pretty print with 4 spaces
-            mempoolOutFile.close();
-        }
-        string filename = "./data/" + to_string(nodeId) + "_mainBlockchain.json";
-        ifstream checkFile(filename);
-        if (checkFile.peek() == ifstream::traits_type::eof())
-        {
-            ofstream initFile(filename);
-            if (initFile.is_open())
-            {
-                initFile << "[]";
-                initFile.close();
-            }
-        }
-        json blockchainJson;
-
-        ifstream inFile(filename);
-        if (inFile.is_open())
-        {
-            inFile >> blockchainJson;
-            inFile.close();
-        }
-
-        json blockJson = {
-            {"index", block.index},
-            {"previousHash", block.previousHash},
-            {"hash", block.hash},
-            {"timestamp", block.timestamp},
-            {"games", json::array()},
-            {"nonce", block.nonce}};
-
-        for (const auto &txn : block.games)
-        {
-            blockJson["games"].push_back(txn.toString());
-        }
-
-        blockchainJson.push_back(blockJson);
-
-        ofstream outFile(filename);
-        if (outFile.is_open())
-        {
-            outFile << blockchainJson.dump(4); // Pretty print with 4 spaces
-            outFile.close();
-        }
+        updateMempoolFile(block.games);
+        updateBlockchainFile(block);
     }
 }
 
@@ -670,8 +602,14 @@ bool MainNode::verifyNewBlock(const MainBlock &block)
         cout << "here2" << endl;
     }
 
-    string target(block.difficulty, '0');
-    if (block.hash.substr(0, block.difficulty) != target)
+    // Check against the difficulty the chain requires at this height, not the one the block declares
+    int required = blockchain.requiredDifficulty(blockchain.size());
+    if (block.index != (int)blockchain.size() || block.difficulty != required)
+        return false;
+    // The header hashes the stored root, so the games must be checked against it first
+    if (!block.merkleRootMatches())
+        return false;
+    if (block.calculateHash(block.nonce) != block.hash || !Miner::meetsTarget(block.hash, required))
         return false;
 
     cout << "here3" << endl;
@@ -683,7 +621,7 @@ void MainNode::addTransaction(const Game &txn)
 {
     if (!isValidTransaction(txn) || !verifyValidGame(txn))
     {
-        logMessage("Invalid transaction received by Node " + to_string(nodeId));
+        NODE_LOG(LogLevel::Warn, "Invalid transaction received by Node " + to_string(nodeId));
         return;
     }
     // Check blockchain for duplicates
@@ -708,59 +646,27 @@ void MainNode::addTransaction(const Game &txn)
         while (!tempQueue.empty())
         {
             const auto &queuedTxn = tempQueue.front();
-            if (queuedTxn.gameId == txn.gameId && queuedTxn.players == txn.players &&
-                queuedTxn.winnerId == txn.winnerId && queuedTxn.gameComplete == txn.gameComplete)
+            if (queuedTxn.digest() == txn.digest())
             {
-                logMessage("Transaction already exists in queue for Node " + to_string(nodeId));
+                NODE_LOG(LogLevel::Debug, "Transaction already exists in queue for Node " + to_string(nodeId));
                 return;
             }
             tempQueue.pop();
         }
+        mempool->add(txn.digest(), ChainCodec::encodeGame(txn)); // Journaled before a miner can take it
         transactionQueue.push(txn);
     }
     cv.notify_all();
     broadcastTransaction(txn);
 
-    // Update mempool file
-    string filename = "./data/" + to_string(nodeId) + "_mainMempool.json";
-    json mempool = json::array();
-
-    ifstream inFile(filename);
-    if (inFile.is_open())
-    {
-        try
-        {
-            inFile >> mempool;
-        }
-        catch (const json::parse_error &e)
-        {
-            cerr << "Error parsing JSON: " << e.what() << endl;
-        }
-        inFile.close();
-    }
-
-    json txnJson = {
-        {"gameId", txn.gameId},
-        {"players", txn.players},
-        {"winnerId", txn.winnerId},
-        {"gameComplete", txn.gameComplete}};
-    mempool.push_back(txnJson);
-
-    ofstream outFile(filename, ios::trunc);
-    if (outFile.is_open())
-    {
-        outFile << mempool.dump(4);
-        outFile.close();
-    }
-
-    logMessage("Transaction added to Node " + to_string(nodeId) + ": " + to_string(txn.gameId));
+    NODE_LOG(LogLevel::Info, "Transaction added to Node " + to_string(nodeId) + ": " + to_string(txn.gameId));
 }
 void MainNode::addTransaction(const Game &txn, MainNode *peer)
 {
 
     if (!isValidTransaction(txn) || !verifyValidGame(txn))
     {
-        logMessage("Invalid transaction received by Node " + to_string(nodeId));
+        NODE_LOG(LogLevel::Warn, "Invalid transaction received by Node " + to_string(nodeId));
         return;
     }
     // Check blockchain for duplicates
@@ -785,52 +691,20 @@ void MainNode::addTransaction(const Game &txn, MainNode *peer)
         while (!tempQueue.empty())
         {
             const auto &queuedTxn = tempQueue.front();
-            if (queuedTxn.gameId == txn.gameId && queuedTxn.players == txn.players &&
-                queuedTxn.winnerId == txn.winnerId && queuedTxn.gameComplete == txn.gameComplete)
+            if (queuedTxn.digest() == txn.digest())
             {
-                logMessage("Transaction already exists in queue for Node " + to_string(nodeId));
+                NODE_LOG(LogLevel::Debug, "Transaction already exists in queue for Node " + to_string(nodeId));
                 return;
             }
             tempQueue.pop();
         }
+        mempool->add(txn.digest(), ChainCodec::encodeGame(txn)); // Journaled before a miner can take it
         transactionQueue.push(txn);
     }
     cv.notify_all();
     broadcastTransaction(txn, peer);
 
-    // Update mempool file
-    string filename = "./data/" + to_string(nodeId) + "_mainMempool.json";
-    json mempool = json::array();
-
-    ifstream inFile(filename);
-    if (inFile.is_open())
-    {
-        try
-        {
-            inFile >> mempool;
-        }
-        catch (const json::parse_error &e)
-        {
-            cerr << "Error parsing JSON: " << e.what() << endl;
-        }
-        inFile.close();
-    }
-
-    json txnJson = {
-        {"gameId", txn.gameId},
-        {"players", txn.players},
-        {"winnerId", txn.winnerId},
-        {"gameComplete", txn.gameComplete}};
-    mempool.push_back(txnJson);
-
-    ofstream outFile(filename, ios::trunc);
-    if (outFile.is_open())
-    {
-        outFile << mempool.dump(4);
-        outFile.close();
-    }
-
-    logMessage("Transaction added to Node " + to_string(nodeId) + ": " + to_string(txn.gameId));
+    NODE_LOG(LogLevel::Info, "Transaction added to Node " + to_string(nodeId) + ": " + to_string(txn.gameId));
 }
 
 void MainNode::stop()
@@ -840,6 +714,27 @@ void MainNode::stop()
         running = false;
     }
     cv.notify_all();
+    cancelMining();
+}
+
+uint64_t MainNode::getWastedHashes() const
+{
+    return wastedHashes;
+}
+
+CheckpointEntry MainNode::checkpoint()
+{
+    CheckpointEntry entry;
+    entry.kind = CheckpointKind::MainNode;
+    entry.id = to_string(nodeId);
+    entry.height = blockchain.size();
+    entry.tip = blockchain.getLastBlock().hash;
+    return entry;
+}
+
+const RecoveryStats &MainNode::getRecoveryStats() const
+{
+    return recovery;
 }
 
 MainNode::~MainNode()
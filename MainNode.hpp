@@ -2,6 +2,8 @@
 #define MAINNODE_HPP
 
 #include <iostream>
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <thread>
 #include <mutex>
@@ -12,19 +14,29 @@
 #include "MainChain.hpp"
 #include "MainBlock.hpp"
 #include "Game.hpp"
+#include "Logger.hpp"
+#include "BlockLog.hpp"
+#include "MempoolJournal.hpp"
+#include "Checkpoint.hpp"
 
 class MainNode
 {
 private:
     MainChain &blockchain;
-    int difficulty;
     std::queue<Game> transactionQueue;
     std::mutex mtx;
     std::mutex mtxPeers;
     std::condition_variable cv;
     std::vector<MainNode *> peers;
+    std::mutex mtxJob;
+    std::shared_ptr<MiningJob> currentJob; // Template being mined, cancelled when the tip moves
+    std::atomic<uint64_t> wastedHashes{0}; // Hashes spent on templates that went stale
+    std::unique_ptr<BlockLog> blockLog;    // ./data/<nodeId>_mainBlockchain.log and .idx
+    std::unique_ptr<MempoolJournal> mempool; // ./data/<nodeId>_mainMempool.snapshot and .journal
+    RecoveryStats recovery;
+    uint64_t savedRatingHeight = 0; // Height of the rating snapshot last written to ./data/<nodeId>_ratings.snap
 
-    void logMessage(const std::string &message);
+    LogLevel logLevel = LogLevel::Info; // Resolved from Logger once the node id is known
     bool isValidTransaction(const Game &txn);
     void broadcastTransaction(const Game &txn);
     void broadcastTransaction(const Game &txn, MainNode *peer);
@@ -34,13 +46,26 @@ private:
     void receiveBlock(const MainBlock &block, MainNode *peer);
     bool verifyNewBlock(const MainBlock &block);
     bool verifyValidGame(const Game &game);
+    void openBlockLog();
+    // Extends the chain with logged blocks, re-validating those past the checkpoint
+    void recoverChain();
+    RatingSnapshot loadRatingSnapshot();
+    // Persists the chain's newest rating snapshot if it has not been written yet
+    void saveRatingSnapshot();
+    // Appends one block to the log
     void updateBlockchainFile(const MainBlock &block);
+    // Replays the persisted mempool into the transaction queue
+    void openMempool();
+    // Journals the removal of games that left the mempool
     void updateMempoolFile(const vector<Game> &transactions);
     void syncPeers();
+    void cancelMining();
+    void requeueDisplaced(const vector<Game> &games, size_t fromHeight);
 
 public:
-    MainNode(MainChain &bc, int diff = 7);
-    MainNode(vector<MainNode *> peers, int diff = 7);
+    // A requestedId of 0 picks a random one; pass the previous id to pick up its files
+    MainNode(MainChain &bc, int requestedId = 0);
+    MainNode(vector<MainNode *> peers, int requestedId = 0);
     bool running = true;
     int nodeId;
 
@@ -48,6 +73,9 @@ public:
     void mineBlock();
     void connectPeer(MainNode *peer);
     void stop();
+    uint64_t getWastedHashes() const;
+    CheckpointEntry checkpoint();
+    const RecoveryStats &getRecoveryStats() const;
     ~MainNode();
 };
 
@@ -0,0 +1,337 @@
+#include "MempoolJournal.hpp"
+#include "Bytes.hpp"
+#include "DurableWriter.hpp"
+#include "ThreadPool.hpp"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static const string JOURNAL_MAGIC = "CCMJ";
+static const string SNAPSHOT_MAGIC = "CCMS";
+static const uint32_t VERSION = 3;
+static const uint8_t OP_ADD = 1;
+static const uint8_t OP_REMOVE = 2;
+
+static string header(const string &magic)
+{
+    string out = magic;
+    appendUint32(out, VERSION);
+    return out;
+}
+
+static string readFile(const string &path)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+    {
+        return "";
+    }
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+MempoolJournal::MempoolJournal(const string &basePath, ReplayOnly)
+    : snapshotPath(basePath + ".snapshot"), journalPath(basePath + ".journal"),
+      oldJournalPath(basePath + ".journal.old"), compactBytes(DEFAULT_COMPACT_BYTES)
+{
+    replaySnapshot();
+    replayJournal(oldJournalPath);
+    replayJournal(journalPath);
+}
+
+MempoolJournal::MempoolJournal(const string &basePath, uint64_t compactBytes)
+    : MempoolJournal(basePath, ReplayOnly{})
+{
+    this->compactBytes = compactBytes;
+
+    // Fold whatever was replayed into a fresh snapshot and start an empty journal
+    vector<pair<Hash256, string>> live(entries.begin(), entries.end());
+    writeSnapshot(live);
+    std::remove(oldJournalPath.c_str());
+    startJournal();
+}
+
+void MempoolJournal::startJournal()
+{
+    journal.clear();
+    journal.open(journalPath, ios::binary | ios::trunc);
+    string start = header(JOURNAL_MAGIC);
+    journal.write(start.data(), start.size());
+    journal.flush();
+    if (!journal)
+    {
+        throw runtime_error("Failed to open " + journalPath + " for writing.");
+    }
+    DurableWriter::instance().commit(journalPath, FileClass::Mempool, true);
+    journalBytes = start.size();
+}
+
+void MempoolJournal::replaySnapshot()
+{
+    string data = readFile(snapshotPath);
+    if (data.empty())
+    {
+        return;
+    }
+
+    ByteReader reader(data);
+    if (reader.readBytes(SNAPSHOT_MAGIC.size()) != SNAPSHOT_MAGIC || reader.readUint32() != VERSION)
+    {
+        throw runtime_error("Unrecognised mempool snapshot " + snapshotPath);
+    }
+    uint32_t count = reader.readUint32();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Hash256 digest = readHash(reader);
+        apply(OP_ADD, digest, reader.readString());
+    }
+}
+
+void MempoolJournal::replayJournal(const string &path)
+{
+    string data = readFile(path);
+    if (data.empty())
+    {
+        return;
+    }
+
+    ByteReader reader(data);
+    if (reader.readBytes(JOURNAL_MAGIC.size()) != JOURNAL_MAGIC || reader.readUint32() != VERSION)
+    {
+        throw runtime_error("Unrecognised mempool journal " + path);
+    }
+    while (!reader.done())
+    {
+        // A record cut short by a crash ends the replay; it was never acknowledged
+        string payload;
+        try
+        {
+            uint32_t length = reader.readUint32();
+            uint32_t checksum = reader.readUint32();
+            payload = reader.readBytes(length);
+            if (crc32(payload) != checksum)
+            {
+                break;
+            }
+        }
+        catch (const runtime_error &)
+        {
+            break;
+        }
+
+        ByteReader record(payload);
+        uint8_t op = record.readUint8();
+        if (op == OP_ADD)
+        {
+            Hash256 digest = readHash(record);
+            apply(OP_ADD, digest, record.readBytes(payload.size() - 1 - digest.size()));
+        }
+        else if (op == OP_REMOVE)
+        {
+            uint32_t count = record.readUint32();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                apply(OP_REMOVE, readHash(record), "");
+            }
+        }
+        else
+        {
+            throw runtime_error("Unknown record type in " + path);
+        }
+    }
+}
+
+void MempoolJournal::apply(uint8_t op, const Hash256 &digest, string entry)
+{
+    auto found = index.find(digest);
+    if (op == OP_ADD && found == index.end())
+    {
+        entries.emplace_back(digest, move(entry));
+        index[digest] = prev(entries.end());
+    }
+    else if (op == OP_REMOVE && found != index.end())
+    {
+        entries.erase(found->second);
+        index.erase(found);
+    }
+}
+
+void MempoolJournal::appendRecord(const string &payload)
+{
+    string record;
+    record.reserve(8 + payload.size());
+    appendUint32(record, (uint32_t)payload.size());
+    appendUint32(record, crc32(payload));
+    record.append(payload);
+
+    journal.write(record.data(), record.size());
+    journal.flush();
+    if (!journal)
+    {
+        throw runtime_error("Failed to append to " + journalPath);
+    }
+    journalBytes += record.size();
+    stats.appends++;
+    stats.bytesAppended += record.size();
+
+    if (journalBytes >= compactBytes && !compacting)
+    {
+        compacting = true;
+        ThreadPool::shared().submit([this]
+                                    { compact(); });
+    }
+}
+
+void MempoolJournal::add(const Hash256 &digest, const string &entry)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        if (index.count(digest))
+        {
+            return;
+        }
+        apply(OP_ADD, digest, entry);
+
+        string payload;
+        payload.reserve(1 + digest.size() + entry.size());
+        appendUint8(payload, OP_ADD);
+        appendHash(payload, digest);
+        payload.append(entry);
+        appendRecord(payload);
+    }
+    // Outside the lock so other appends can join the same group commit
+    DurableWriter::instance().commit(journalPath, FileClass::Mempool);
+}
+
+void MempoolJournal::remove(const vector<Hash256> &digests)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        vector<Hash256> present;
+        for (const auto &digest : digests)
+        {
+            if (index.count(digest))
+            {
+                present.push_back(digest);
+                apply(OP_REMOVE, digest, "");
+            }
+        }
+        if (present.empty())
+        {
+            return;
+        }
+
+        string payload;
+        appendUint8(payload, OP_REMOVE);
+        appendUint32(payload, (uint32_t)present.size());
+        for (const auto &digest : present)
+        {
+            appendHash(payload, digest);
+        }
+        appendRecord(payload);
+    }
+    DurableWriter::instance().commit(journalPath, FileClass::Mempool);
+}
+
+void MempoolJournal::rotate(vector<pair<Hash256, string>> &live)
+{
+    live.assign(entries.begin(), entries.end());
+
+    // An old journal left by a failed compaction is still only covered by this snapshot,
+    // so it is kept and the current journal stays where it is until that succeeds
+    if (ifstream(oldJournalPath).is_open())
+    {
+        return;
+    }
+    journal.close();
+    // Appends not yet committed by their callers must not move out from under the commit
+    DurableWriter::instance().commit(journalPath, FileClass::Mempool);
+    if (rename(journalPath.c_str(), oldJournalPath.c_str()) != 0)
+    {
+        throw runtime_error("Failed to rotate " + journalPath);
+    }
+    startJournal();
+}
+
+void MempoolJournal::writeSnapshot(const vector<pair<Hash256, string>> &live)
+{
+    string data = header(SNAPSHOT_MAGIC);
+    appendUint32(data, (uint32_t)live.size());
+    for (const auto &entry : live)
+    {
+        appendHash(data, entry.first);
+        appendString(data, entry.second);
+    }
+
+    DurableWriter::instance().replace(snapshotPath, data, FileClass::Mempool);
+}
+
+void MempoolJournal::compact()
+{
+    bool written = false;
+    try
+    {
+        vector<pair<Hash256, string>> live;
+        {
+            lock_guard<mutex> lock(mtx);
+            rotate(live);
+        }
+        // The snapshot covers everything up to the rotation, so the old journal can go
+        writeSnapshot(live);
+        std::remove(oldJournalPath.c_str());
+        written = true;
+    }
+    catch (const exception &e)
+    {
+        cerr << "Mempool compaction failed: " << e.what() << endl;
+    }
+
+    lock_guard<mutex> lock(mtx);
+    compacting = false;
+    if (written)
+    {
+        stats.compactions++;
+    }
+    cv.notify_all();
+}
+
+vector<string> MempoolJournal::read(const string &basePath)
+{
+    MempoolJournal replayed(basePath, ReplayOnly{});
+    return replayed.contents();
+}
+
+vector<string> MempoolJournal::contents() const
+{
+    lock_guard<mutex> lock(mtx);
+    vector<string> out;
+    out.reserve(entries.size());
+    for (const auto &entry : entries)
+    {
+        out.push_back(entry.second);
+    }
+    return out;
+}
+
+size_t MempoolJournal::size() const
+{
+    lock_guard<mutex> lock(mtx);
+    return entries.size();
+}
+
+MempoolJournalStats MempoolJournal::getStats() const
+{
+    lock_guard<mutex> lock(mtx);
+    return stats;
+}
+
+MempoolJournal::~MempoolJournal()
+{
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [this]
+            { return !compacting; });
+}
@@ -0,0 +1,83 @@
+#ifndef MEMPOOLJOURNAL_HPP
+#define MEMPOOLJOURNAL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Hash256.hpp"
+
+struct MempoolJournalStats
+{
+    uint64_t appends = 0;       // Records written, one per add or per batch of removals
+    uint64_t bytesAppended = 0; // Journal bytes written since startup
+    uint64_t compactions = 0;   // Snapshots written
+};
+
+// Mempool persistence as <base>.snapshot plus an append-only <base>.journal of add and
+// remove records, each [u32 length][u32 CRC-32][payload]. An add carries a digest and
+// its entry, a remove the digests a block took out of the pool. Entries are
+// opaque bytes keyed by digest. Once the journal passes the threshold it is rotated to
+// <base>.journal.old and a new snapshot is written on the shared thread pool. Opening
+// replays snapshot, old journal and journal; a torn last record is ignored. Replay is
+// idempotent, so a crash at any point of a compaction loses nothing.
+class MempoolJournal
+{
+private:
+    std::string snapshotPath;
+    std::string journalPath;
+    std::string oldJournalPath;
+    uint64_t compactBytes;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::list<std::pair<Hash256, std::string>> entries; // Insertion order
+    std::unordered_map<Hash256, std::list<std::pair<Hash256, std::string>>::iterator> index;
+    std::ofstream journal;
+    uint64_t journalBytes = 0;
+    bool compacting = false;
+    MempoolJournalStats stats;
+
+    void replaySnapshot();
+    void replayJournal(const std::string &path);
+    void apply(uint8_t op, const Hash256 &digest, std::string entry);
+    void appendRecord(const std::string &payload);
+    void startJournal();
+    void rotate(std::vector<std::pair<Hash256, std::string>> &live);
+    void writeSnapshot(const std::vector<std::pair<Hash256, std::string>> &live);
+    void compact();
+
+    struct ReplayOnly
+    {
+    };
+    MempoolJournal(const std::string &basePath, ReplayOnly);
+
+public:
+    static const uint64_t DEFAULT_COMPACT_BYTES = 64 * 1024;
+
+    explicit MempoolJournal(const std::string &basePath, uint64_t compactBytes = DEFAULT_COMPACT_BYTES);
+    MempoolJournal(const MempoolJournal &) = delete;
+    MempoolJournal &operator=(const MempoolJournal &) = delete;
+
+    // One append each; adding a digest already present is a no-op
+    void add(const Hash256 &digest, const std::string &entry);
+    void remove(const std::vector<Hash256> &digests);
+
+    // Live entries in the order they were added
+    std::vector<std::string> contents() const;
+    // The same for offline tools: replays the files without writing, truncating or
+    // removing any of them, so a node using them is left undisturbed
+    static std::vector<std::string> read(const std::string &basePath);
+    size_t size() const;
+    MempoolJournalStats getStats() const;
+
+    // Waits for a running compaction
+    ~MempoolJournal();
+};
+
+#endif
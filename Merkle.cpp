@@ -0,0 +1,114 @@
+#include "Merkle.hpp"
+#include <stdexcept>
+
+using namespace std;
+
+static const unsigned char LEAF_PREFIX = 0x00;
+static const unsigned char NODE_PREFIX = 0x01;
+
+Sha256::Digest Merkle::leafHash(const string &data)
+{
+    Sha256 sha;
+    sha.update(&LEAF_PREFIX, 1);
+    sha.update(data);
+    return sha.final();
+}
+
+Sha256::Digest Merkle::leafHash(const Sha256::Digest &itemDigest)
+{
+    Sha256 sha;
+    sha.update(&LEAF_PREFIX, 1);
+    sha.update(itemDigest.data(), itemDigest.size());
+    return sha.final();
+}
+
+Sha256::Digest Merkle::nodeHash(const Sha256::Digest &left, const Sha256::Digest &right)
+{
+    Sha256 sha;
+    sha.update(&NODE_PREFIX, 1);
+    sha.update(left.data(), left.size());
+    sha.update(right.data(), right.size());
+    return sha.final();
+}
+
+static vector<Sha256::Digest> nextLevel(const vector<Sha256::Digest> &level)
+{
+    vector<Sha256::Digest> next;
+    next.reserve((level.size() + 1) / 2);
+    for (size_t i = 0; i < level.size(); i += 2)
+    {
+        if (i + 1 < level.size())
+            next.push_back(Merkle::nodeHash(level[i], level[i + 1]));
+        else
+            next.push_back(level[i]);
+    }
+    return next;
+}
+
+Sha256::Digest Merkle::root(const vector<Sha256::Digest> &leaves)
+{
+    if (leaves.empty())
+    {
+        return Sha256::Digest{};
+    }
+
+    vector<Sha256::Digest> level = leaves;
+    while (level.size() > 1)
+    {
+        level = nextLevel(level);
+    }
+    return level[0];
+}
+
+MerkleProof Merkle::prove(const vector<Sha256::Digest> &leaves, size_t index)
+{
+    if (index >= leaves.size())
+    {
+        throw out_of_range("Merkle leaf index out of range");
+    }
+
+    MerkleProof proof;
+    proof.index = index;
+    proof.leafCount = leaves.size();
+
+    vector<Sha256::Digest> level = leaves;
+    size_t position = index;
+    while (level.size() > 1)
+    {
+        size_t sibling = position ^ 1;
+        if (sibling < level.size())
+        {
+            proof.siblings.push_back(level[sibling]);
+        }
+        level = nextLevel(level);
+        position /= 2;
+    }
+    return proof;
+}
+
+bool Merkle::verify(const Sha256::Digest &leaf, const MerkleProof &proof, const Sha256::Digest &root)
+{
+    if (proof.index >= proof.leafCount)
+    {
+        return false;
+    }
+
+    Sha256::Digest current = leaf;
+    size_t position = proof.index;
+    size_t width = proof.leafCount;
+    size_t next = 0;
+    while (width > 1)
+    {
+        size_t sibling = position ^ 1;
+        if (sibling < width)
+        {
+            if (next >= proof.siblings.size())
+                return false;
+            const Sha256::Digest &other = proof.siblings[next++];
+            current = (position & 1) ? nodeHash(other, current) : nodeHash(current, other);
+        }
+        position /= 2;
+        width = (width + 1) / 2;
+    }
+    return next == proof.siblings.size() && current == root;
+}
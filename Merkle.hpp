@@ -0,0 +1,33 @@
+#ifndef MERKLE_HPP
+#define MERKLE_HPP
+
+#include <string>
+#include <vector>
+#include "Sha256.hpp"
+
+// Sibling path from one leaf up to the root
+struct MerkleProof
+{
+    size_t index = 0;     // Position of the leaf
+    size_t leafCount = 0; // Leaves in the tree, needed to know where odd nodes were promoted
+    std::vector<Sha256::Digest> siblings;
+};
+
+// Binary SHA-256 Merkle tree. Leaves and interior nodes are hashed with different
+// prefixes so an interior node can never be passed off as a leaf, and an odd node at
+// the end of a level is promoted unchanged instead of being paired with itself.
+class Merkle
+{
+public:
+    static Sha256::Digest leafHash(const std::string &data);
+    // Leaf over an item's cached digest, so the item itself is not re-encoded
+    static Sha256::Digest leafHash(const Sha256::Digest &itemDigest);
+    static Sha256::Digest nodeHash(const Sha256::Digest &left, const Sha256::Digest &right);
+
+    // Root over leaf hashes; all zeros for an empty tree
+    static Sha256::Digest root(const std::vector<Sha256::Digest> &leaves);
+    static MerkleProof prove(const std::vector<Sha256::Digest> &leaves, size_t index);
+    static bool verify(const Sha256::Digest &leaf, const MerkleProof &proof, const Sha256::Digest &root);
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "Miner.hpp"
+#include "MiningKernel.hpp"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static atomic<unsigned int> configuredThreads{0};
+
+double MiningResult::hashesPerSecond() const
+{
+    if (seconds <= 0.0)
+    {
+        return 0.0;
+    }
+    return hashes / seconds;
+}
+
+void MiningJob::cancel()
+{
+    cancelled = true;
+}
+
+bool MiningJob::isCancelled() const
+{
+    return cancelled;
+}
+
+Miner::Miner(unsigned int threads)
+{
+    this->threads = threads == 0 ? defaultThreads() : threads;
+}
+
+void Miner::setDefaultThreads(unsigned int threads)
+{
+    configuredThreads = threads;
+}
+
+unsigned int Miner::defaultThreads()
+{
+    unsigned int threads = configuredThreads;
+    if (threads == 0)
+    {
+        threads = thread::hardware_concurrency();
+    }
+    return threads == 0 ? 1 : threads;
+}
+
+bool Miner::meetsTarget(const Sha256::Digest &digest, int zeroBits)
+{
+    if (zeroBits > (int)Sha256::DIGEST_SIZE * 8)
+    {
+        return false;
+    }
+    for (int i = 0; i < zeroBits / 8; i++)
+    {
+        if (digest[i] != 0)
+            return false;
+    }
+    return zeroBits % 8 == 0 || (digest[zeroBits / 8] >> (8 - zeroBits % 8)) == 0;
+}
+
+unsigned int Miner::threadCount() const
+{
+    return threads;
+}
+
+MiningResult Miner::mine(const HeaderHasher &hasher, int difficulty, int startNonce, const MiningJob *job)
+{
+    const MiningKernel &kernel = MiningKernel::best();
+    const long long stride = (long long)threads * kernel.lanes;
+    atomic<bool> found{false};
+    atomic<uint64_t> totalHashes{0};
+    mutex resultMtx;
+    MiningResult result;
+
+    auto start = chrono::steady_clock::now();
+
+    // Worker w takes the w-th batch of every stride, so the nonce space is split without overlap
+    auto worker = [&](unsigned int offset)
+    {
+        uint64_t hashes = 0;
+        for (long long first = (long long)startNonce + (long long)offset * kernel.lanes;
+             first + kernel.lanes - 1 <= INT_MAX && !found && !(job && job->isCancelled()); first += stride)
+        {
+            int lane = kernel.search(hasher, (uint32_t)first, difficulty);
+            hashes += kernel.lanes;
+            if (lane >= 0)
+            {
+                lock_guard<mutex> lock(resultMtx);
+                if (!found)
+                {
+                    found = true;
+                    result.nonce = (int)(first + lane);
+                    result.hash = hasher.hash(result.nonce);
+                }
+                break;
+            }
+        }
+        totalHashes += hashes;
+    };
+
+    if (threads == 1)
+    {
+        worker(0);
+    }
+    else
+    {
+        vector<thread> workers;
+        for (unsigned int i = 0; i < threads; i++)
+        {
+            workers.emplace_back(worker, i);
+        }
+        for (auto &t : workers)
+        {
+            t.join();
+        }
+    }
+
+    result.found = found;
+    result.cancelled = !found && job && job->isCancelled();
+    result.hashes = totalHashes;
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
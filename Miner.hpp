@@ -0,0 +1,54 @@
+#ifndef MINER_HPP
+#define MINER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "BlockHeader.hpp"
+
+struct MiningResult
+{
+    bool found = false;
+    int nonce = 0;
+    Hash256 hash;
+    bool cancelled = false; // Stopped through its MiningJob before finding a nonce
+    uint64_t hashes = 0;    // Hash attempts across all workers
+    double seconds = 0.0;
+
+    double hashesPerSecond() const;
+};
+
+// Cancellation token for one block template. Whoever makes the template stale
+// (e.g. by accepting a competing block on the same tip) cancels it and every
+// worker stops at its next batch.
+class MiningJob
+{
+private:
+    std::atomic<bool> cancelled{false};
+
+public:
+    void cancel();
+    bool isCancelled() const;
+};
+
+class Miner
+{
+private:
+    unsigned int threads;
+
+public:
+    // threads == 0 uses the process-wide default
+    Miner(unsigned int threads = 0);
+
+    unsigned int threadCount() const;
+    // Searches nonces from startNonce in batches of MiningKernel::best().lanes per call.
+    // difficulty is the number of leading zero bits the header hash must have.
+    MiningResult mine(const HeaderHasher &hasher, int difficulty, int startNonce = 1, const MiningJob *job = nullptr);
+
+    static bool meetsTarget(const Sha256::Digest &digest, int zeroBits);
+
+    static void setDefaultThreads(unsigned int threads);
+    static unsigned int defaultThreads();
+};
+
+#endif
@@ -0,0 +1,347 @@
+#include "MiningKernel.hpp"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <openssl/sha.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINING_KERNEL_X86 1
+#endif
+
+using namespace std;
+
+static const uint32_t NONCE_WORD = (BlockHeader::NONCE_OFFSET - Sha256::BLOCK_SIZE) / 4;
+
+static void loadWords(const unsigned char *block, uint32_t words[16])
+{
+    for (int i = 0; i < 16; i++)
+    {
+        words[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+                   (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+    }
+}
+
+static void putNonce(unsigned char *block, uint32_t nonce)
+{
+    unsigned char *out = block + NONCE_WORD * 4;
+    out[0] = (unsigned char)(nonce >> 24);
+    out[1] = (unsigned char)(nonce >> 16);
+    out[2] = (unsigned char)(nonce >> 8);
+    out[3] = (unsigned char)nonce;
+}
+
+static void hashScalar(const HeaderHasher &hasher, uint32_t firstNonce, unsigned int lanes, MiningKernel::Batch &out)
+{
+    array<unsigned char, Sha256::BLOCK_SIZE> block = hasher.finalBlock();
+    for (unsigned int lane = 0; lane < lanes; lane++)
+    {
+        putNonce(block.data(), firstNonce + lane);
+        Sha256::State state = hasher.prefixState();
+        Sha256::compress(state, block.data());
+        for (int i = 0; i < 8; i++)
+        {
+            out.words[i][lane] = state[i];
+        }
+    }
+}
+
+#ifdef MINING_KERNEL_X86
+
+// Single-buffer SHA-NI compression, run once per lane
+__attribute__((target("sha,sse4.1,ssse3"))) static void compressShaNi(uint32_t state[8], const unsigned char *block)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1); // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                      // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);                                           // CDGH
+    const __m128i abefSave = state0;
+    const __m128i cdghSave = state1;
+
+    __m128i msgs[4];
+    for (int i = 0; i < 16; i++)
+    {
+        if (i < 4)
+        {
+            msgs[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(block + i * 16)), byteSwap);
+        }
+        __m128i msg = _mm_add_epi32(msgs[i % 4], _mm_loadu_si128((const __m128i *)&Sha256::ROUND_CONSTANTS[i * 4]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        if (i >= 3 && i < 15)
+        {
+            // Finish the schedule for word group i + 1
+            __m128i &next = msgs[(i + 1) % 4];
+            next = _mm_add_epi32(next, _mm_alignr_epi8(msgs[i % 4], msgs[(i + 3) % 4], 4));
+            next = _mm_sha256msg2_epu32(next, msgs[i % 4]);
+        }
+        msg = _mm_shuffle_epi32(msg, 0x0E);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        if (i >= 1 && i < 13)
+        {
+            msgs[(i + 3) % 4] = _mm_sha256msg1_epu32(msgs[(i + 3) % 4], msgs[i % 4]);
+        }
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);       // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);    // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);    // ABEF
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+static void hashShaNi(const HeaderHasher &hasher, uint32_t firstNonce, unsigned int lanes, MiningKernel::Batch &out)
+{
+    array<unsigned char, Sha256::BLOCK_SIZE> block = hasher.finalBlock();
+    for (unsigned int lane = 0; lane < lanes; lane++)
+    {
+        putNonce(block.data(), firstNonce + lane);
+        uint32_t state[8];
+        memcpy(state, hasher.prefixState().data(), sizeof(state));
+        compressShaNi(state, block.data());
+        for (int i = 0; i < 8; i++)
+        {
+            out.words[i][lane] = state[i];
+        }
+    }
+}
+
+// Multi-buffer kernels: one SIMD lane per nonce, all lanes share the midstate and
+// every message word except the nonce.
+#define SHA256_LANES(V, SET1, ADD, XOR, AND, ANDNOT, OR, ROR, SHR)                                     \
+    V w[64];                                                                                        \
+    for (int i = 0; i < 16; i++)                                                                    \
+        w[i] = SET1(tail[i]);                                                                       \
+    w[NONCE_WORD] = ADD(SET1(firstNonce), laneOffsets);                                             \
+    for (int i = 16; i < 64; i++)                                                                   \
+    {                                                                                               \
+        V s0 = XOR(XOR(ROR(w[i - 15], 7), ROR(w[i - 15], 18)), SHR(w[i - 15], 3));                  \
+        V s1 = XOR(XOR(ROR(w[i - 2], 17), ROR(w[i - 2], 19)), SHR(w[i - 2], 10));                   \
+        w[i] = ADD(ADD(w[i - 16], s0), ADD(w[i - 7], s1));                                          \
+    }                                                                                               \
+    V a = SET1(mid[0]), b = SET1(mid[1]), c = SET1(mid[2]), d = SET1(mid[3]);                       \
+    V e = SET1(mid[4]), f = SET1(mid[5]), g = SET1(mid[6]), h = SET1(mid[7]);                       \
+    for (int i = 0; i < 64; i++)                                                                    \
+    {                                                                                               \
+        V sigma1 = XOR(XOR(ROR(e, 6), ROR(e, 11)), ROR(e, 25));                                     \
+        V ch = XOR(AND(e, f), ANDNOT(e, g));                                                        \
+        V t1 = ADD(ADD(ADD(h, sigma1), ADD(ch, SET1(Sha256::ROUND_CONSTANTS[i]))), w[i]);           \
+        V sigma0 = XOR(XOR(ROR(a, 2), ROR(a, 13)), ROR(a, 22));                                     \
+        V maj = XOR(XOR(AND(a, b), AND(a, c)), AND(b, c));                                          \
+        h = g;                                                                                      \
+        g = f;                                                                                      \
+        f = e;                                                                                      \
+        e = ADD(d, t1);                                                                             \
+        d = c;                                                                                      \
+        c = b;                                                                                      \
+        b = a;                                                                                      \
+        a = ADD(t1, ADD(sigma0, maj));                                                              \
+    }                                                                                               \
+    V result[8] = {ADD(a, SET1(mid[0])), ADD(b, SET1(mid[1])), ADD(c, SET1(mid[2])), ADD(d, SET1(mid[3])), \
+                   ADD(e, SET1(mid[4])), ADD(f, SET1(mid[5])), ADD(g, SET1(mid[6])), ADD(h, SET1(mid[7]))};
+
+#define AVX2_SET1(x) _mm256_set1_epi32((int)(x))
+#define AVX2_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+__attribute__((target("avx2"))) static void hashAvx2Lanes(const uint32_t *mid, const uint32_t *tail, uint32_t firstNonce,
+                                                          MiningKernel::Batch &out)
+{
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    SHA256_LANES(__m256i, AVX2_SET1, _mm256_add_epi32, _mm256_xor_si256, _mm256_and_si256,
+                 _mm256_andnot_si256, _mm256_or_si256, AVX2_ROR, _mm256_srli_epi32)
+    for (int i = 0; i < 8; i++)
+    {
+        _mm256_storeu_si256((__m256i *)out.words[i], result[i]);
+    }
+}
+
+#define AVX512_SET1(x) _mm512_set1_epi32((int)(x))
+
+__attribute__((target("avx512f"))) static void hashAvx512Lanes(const uint32_t *mid, const uint32_t *tail, uint32_t firstNonce,
+                                                               MiningKernel::Batch &out)
+{
+    const __m512i laneOffsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    SHA256_LANES(__m512i, AVX512_SET1, _mm512_add_epi32, _mm512_xor_si512, _mm512_and_si512,
+                 _mm512_andnot_si512, _mm512_or_si512, _mm512_ror_epi32, _mm512_srli_epi32)
+    for (int i = 0; i < 8; i++)
+    {
+        _mm512_storeu_si512((void *)out.words[i], result[i]);
+    }
+}
+
+#endif
+
+Sha256::Digest MiningKernel::Batch::digest(unsigned int lane) const
+{
+    Sha256::State state;
+    for (int i = 0; i < 8; i++)
+    {
+        state[i] = words[i][lane];
+    }
+    return Sha256::digestFromState(state);
+}
+
+bool MiningKernel::Batch::meetsTarget(unsigned int lane, int zeroBits) const
+{
+    if (zeroBits > 256)
+    {
+        return false;
+    }
+    int word = 0;
+    for (; zeroBits >= 32; zeroBits -= 32, word++)
+    {
+        if (words[word][lane] != 0)
+            return false;
+    }
+    return zeroBits == 0 || (words[word][lane] >> (32 - zeroBits)) == 0;
+}
+
+void MiningKernel::hashBatch(const HeaderHasher &hasher, uint32_t firstNonce, Batch &out) const
+{
+#ifdef MINING_KERNEL_X86
+    if (backend == AVX2 || backend == AVX512)
+    {
+        uint32_t tail[16];
+        loadWords(hasher.finalBlock().data(), tail);
+        if (backend == AVX2)
+            hashAvx2Lanes(hasher.prefixState().data(), tail, firstNonce, out);
+        else
+            hashAvx512Lanes(hasher.prefixState().data(), tail, firstNonce, out);
+        return;
+    }
+    if (backend == SHA_NI)
+    {
+        hashShaNi(hasher, firstNonce, lanes, out);
+        return;
+    }
+#endif
+    hashScalar(hasher, firstNonce, lanes, out);
+}
+
+int MiningKernel::search(const HeaderHasher &hasher, uint32_t firstNonce, int zeroBits) const
+{
+    Batch batch;
+    hashBatch(hasher, firstNonce, batch);
+    for (unsigned int lane = 0; lane < lanes; lane++)
+    {
+        if (batch.meetsTarget(lane, zeroBits))
+            return lane;
+    }
+    return -1;
+}
+
+bool MiningKernel::selfTest() const
+{
+    BlockHeader header;
+    header.index = 42;
+    header.timestamp = 1700000000;
+    for (size_t i = 0; i < Sha256::DIGEST_SIZE; i++)
+    {
+        header.previousHash[i] = (unsigned char)(i * 7 + 1);
+        header.merkleRoot[i] = (unsigned char)(255 - i * 3);
+    }
+    HeaderHasher hasher(header);
+
+    // Include a batch that crosses a byte boundary of the nonce
+    for (uint32_t first : {0u, 250u, 0xfffffff0u})
+    {
+        Batch batch;
+        hashBatch(hasher, first, batch);
+        for (unsigned int lane = 0; lane < lanes; lane++)
+        {
+            header.nonce = first + lane;
+            auto bytes = header.serialize();
+            unsigned char expected[SHA256_DIGEST_LENGTH];
+            SHA256(bytes.data(), bytes.size(), expected);
+            if (memcmp(expected, batch.digest(lane).data(), SHA256_DIGEST_LENGTH) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+vector<MiningKernel> MiningKernel::available()
+{
+    vector<MiningKernel> kernels = {{SCALAR, "scalar", 4}};
+#ifdef MINING_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1"))
+        kernels.push_back({SHA_NI, "sha-ni", 4});
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back({AVX2, "avx2", 8});
+    if (__builtin_cpu_supports("avx512f"))
+        kernels.push_back({AVX512, "avx512", 16});
+#endif
+    return kernels;
+}
+
+// Nonces per second of one kernel on one thread
+static double measure(const MiningKernel &kernel, double seconds)
+{
+    BlockHeader header;
+    HeaderHasher hasher(header);
+    MiningKernel::Batch batch;
+    uint64_t hashes = 0;
+    uint32_t nonce = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < seconds)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            kernel.hashBatch(hasher, nonce, batch);
+            nonce += kernel.lanes;
+        }
+        hashes += 256 * kernel.lanes;
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    return hashes / elapsed;
+}
+
+const MiningKernel &MiningKernel::best()
+{
+    static const MiningKernel selected = []
+    {
+        MiningKernel chosen = {SCALAR, "scalar", 4};
+        double bestRate = 0.0;
+        for (const auto &kernel : available())
+        {
+            if (!kernel.selfTest())
+            {
+                cerr << "Mining kernel " << kernel.name << " failed its self-test, skipping" << endl;
+                continue;
+            }
+            // SHA-NI often beats the multi-buffer kernels, so rank them with a short calibration run
+            double rate = measure(kernel, 0.02);
+            if (rate > bestRate)
+            {
+                bestRate = rate;
+                chosen = kernel;
+            }
+        }
+        return chosen;
+    }();
+    return selected;
+}
+
+void MiningKernel::benchmark(ostream &out, double secondsPerKernel)
+{
+    out << "Mining kernel benchmark (single thread, " << secondsPerKernel << "s per kernel)" << endl;
+    for (const auto &kernel : available())
+    {
+        bool ok = kernel.selfTest();
+        out << "  " << left << setw(8) << kernel.name << " lanes=" << setw(3) << kernel.lanes
+            << " self-test=" << (ok ? "pass" : "FAIL");
+        if (ok)
+        {
+            out << " " << fixed << setprecision(2) << measure(kernel, secondsPerKernel) / 1e6 << " MH/s";
+        }
+        out << endl;
+    }
+    out << "Selected: " << best().name << endl;
+}
@@ -0,0 +1,54 @@
+#ifndef MININGKERNEL_HPP
+#define MININGKERNEL_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "BlockHeader.hpp"
+
+// Multi-nonce SHA-256 search over a HeaderHasher template. Each call hashes `lanes`
+// consecutive nonces at once (SHA-NI, AVX2 or AVX-512 when the CPU has them,
+// scalar code otherwise) and checks the digests against the target in binary.
+class MiningKernel
+{
+public:
+    enum Backend
+    {
+        SCALAR,
+        SHA_NI,
+        AVX2,
+        AVX512
+    };
+
+    static const unsigned int MAX_LANES = 16;
+
+    // Final SHA-256 state words of every lane, word-major so SIMD lanes store directly
+    struct Batch
+    {
+        uint32_t words[8][MAX_LANES];
+
+        Sha256::Digest digest(unsigned int lane) const;
+        bool meetsTarget(unsigned int lane, int zeroBits) const;
+    };
+
+    Backend backend;
+    const char *name;
+    unsigned int lanes;
+
+    // Hashes nonces [firstNonce, firstNonce + lanes)
+    void hashBatch(const HeaderHasher &hasher, uint32_t firstNonce, Batch &out) const;
+    // Returns the first lane whose digest has at least zeroBits leading zero bits, or -1
+    int search(const HeaderHasher &hasher, uint32_t firstNonce, int zeroBits) const;
+
+    // Compares every lane against OpenSSL's SHA256 over the serialized header
+    bool selfTest() const;
+
+    // Kernels this CPU can run, scalar first
+    static std::vector<MiningKernel> available();
+    // Fastest available kernel that passes its self-test; selected once per process
+    static const MiningKernel &best();
+
+    static void benchmark(std::ostream &out, double secondsPerKernel = 1.0);
+};
+
+#endif
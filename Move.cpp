@@ -5,133 +5,117 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <cassert>
 
 #include "Move.hpp"
+#include "Bytes.hpp"
+#include "SignatureCache.hpp"
 
 using namespace std;
 
-Move::Move(std::string sender, std::string receiver, string data)
+Move::Move(const Address &sender, const Address &receiver, ChessMove chessMove)
 {
     this->sender = sender;
     this->receiver = receiver;
-    this->data = data;
+    this->chessMove = chessMove;
     this->id = 1000000000 + rand() % 9000000000;
 }
 
-void Move::signTransaction(const std::string &privateKey)
+std::string Move::signedMessage() const
 {
-    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-    EVP_PKEY *pkey = nullptr;
-    BIO *bio = BIO_new_mem_buf(privateKey.c_str(), -1);
+    std::string message;
+    message.reserve(sender.size() + receiver.size() + 2);
+    message.append(reinterpret_cast<const char *>(sender.data()), sender.size());
+    message.append(reinterpret_cast<const char *>(receiver.data()), receiver.size());
+    appendUint16(message, chessMove.packed());
+    return message;
+}
 
-    if (!PEM_read_bio_PrivateKey(bio, &pkey, nullptr, nullptr))
+void Move::signTransaction(const std::string &privateKey)
+{
+    KeyHandle key = KeyCache::parsePrivateKey(privateKey);
+    if (!key)
     {
         std::cerr << "Error reading private key" << std::endl;
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
-        return;
-    }
-
-    if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, pkey) <= 0)
-    {
-        std::cerr << "Error initializing digest sign" << std::endl;
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
-        return;
-    }
-
-    std::stringstream ss;
-    ss << sender << receiver << data;
-    std::string data = ss.str();
-
-    if (EVP_DigestSignUpdate(ctx, data.c_str(), data.size()) <= 0)
-    {
-        std::cerr << "Error updating digest sign" << std::endl;
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
-        return;
-    }
-
-    size_t sigLen = 0;
-    if (EVP_DigestSignFinal(ctx, nullptr, &sigLen) <= 0)
-    {
-        std::cerr << "Error finalizing digest sign (getting length)" << std::endl;
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
         return;
     }
+    signTransaction(key.get());
+}
 
-    unsigned char *sig = new unsigned char[sigLen];
-    if (EVP_DigestSignFinal(ctx, sig, &sigLen) <= 0)
+void Move::signTransaction(EVP_PKEY *privateKey)
+{
+    scheme = SignatureScheme::algorithmOf(privateKey);
+    std::string sig = SignatureScheme::get(scheme).sign(privateKey, signedMessage());
+    if (sig.empty())
     {
-        std::cerr << "Error finalizing digest sign" << std::endl;
-        delete[] sig;
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
+        std::cerr << "Error signing move" << std::endl;
         return;
     }
 
-    signature = std::string(reinterpret_cast<char *>(sig), sigLen);
-
-    delete[] sig;
-    EVP_PKEY_free(pkey);
-    BIO_free(bio);
-    EVP_MD_CTX_free(ctx);
+    signature = sig;
+    seal();
 }
 
 bool Move::isValid() const
 {
-    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-    EVP_PKEY *pkey = nullptr;
-    BIO *bio = BIO_new_mem_buf(sender.c_str(), -1);
-
-    if (!PEM_read_bio_PUBKEY(bio, &pkey, nullptr, nullptr))
+    Sha256::Digest key = verificationDigest();
+    if (SignatureCache::instance().contains(key))
     {
-        std::cerr << "Error reading public key" << std::endl;
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
-        return false;
+        return true;
     }
-
-    if (EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, pkey) <= 0)
+    if (!verifySignature())
     {
-        std::cerr << "Error initializing digest verify" << std::endl;
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
         return false;
     }
+    SignatureCache::instance().insert(key);
+    return true;
+}
 
-    std::stringstream ss;
-    ss << sender << receiver << data;
-    std::string data = ss.str();
+Sha256::Digest Move::verificationDigest() const
+{
+    // The signed message starts with the sender address, which names the key
+    Sha256 sha;
+    unsigned char algorithm = (unsigned char)scheme;
+    sha.update(&algorithm, 1);
+    std::string message = signedMessage();
+    sha.update(message);
+    std::string length;
+    appendUint32(length, (uint32_t)signature.size());
+    sha.update(length);
+    sha.update(signature);
+    return sha.final();
+}
 
-    if (EVP_DigestVerifyUpdate(ctx, data.c_str(), data.size()) <= 0)
+bool Move::verifySignature() const
+{
+    KeyHandle key = KeyCache::instance().publicKey(sender);
+    if (!key)
     {
-        std::cerr << "Error updating digest verify" << std::endl;
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        EVP_MD_CTX_free(ctx);
+        std::cerr << "No public key registered for sender " << sender << std::endl;
         return false;
     }
 
-    bool result = EVP_DigestVerifyFinal(ctx, reinterpret_cast<const unsigned char *>(signature.c_str()), signature.size()) == 1;
-
-    EVP_PKEY_free(pkey);
-    BIO_free(bio);
-    EVP_MD_CTX_free(ctx);
+    // verify() also rejects a sender key that doesn't belong to the recorded scheme
+    return SignatureScheme::get(scheme).verify(key.get(), signedMessage(), signature);
+}
 
-    return result;
+std::string Move::encodeCanonical() const
+{
+    std::string out;
+    out.reserve(11 + sender.size() + receiver.size() + signature.size());
+    appendUint32(out, (uint32_t)id);
+    appendUint8(out, (uint8_t)scheme);
+    out.append(reinterpret_cast<const char *>(sender.data()), sender.size());
+    out.append(reinterpret_cast<const char *>(receiver.data()), receiver.size());
+    appendUint16(out, chessMove.packed());
+    appendString(out, signature);
+    return out;
 }
 
-std::string Move::toString() const
+std::string Move::describe() const
 {
     std::ostringstream ss;
-    ss << sender << receiver << data;
+    ss << sender << receiver << chessMove.toUci();
 
     for (unsigned char c : signature)
     {
@@ -140,3 +124,52 @@ std::string Move::toString() const
 
     return ss.str();
 }
+
+void Move::seal()
+{
+    cachedCanonical = encodeCanonical();
+    cachedDigest = Sha256::hash(cachedCanonical);
+    cachedString = describe();
+    sealed = true;
+}
+
+bool Move::isSealed() const
+{
+    return sealed;
+}
+
+void Move::checkUnchanged() const
+{
+    // Debug builds re-encode on every access to catch a field changed after sealing
+    assert(encodeCanonical() == cachedCanonical && "Move modified after it was sealed");
+}
+
+std::string Move::canonicalBytes() const
+{
+    if (!sealed)
+        return encodeCanonical();
+#ifndef NDEBUG
+    checkUnchanged();
+#endif
+    return cachedCanonical;
+}
+
+Sha256::Digest Move::digest() const
+{
+    if (!sealed)
+        return Sha256::hash(encodeCanonical());
+#ifndef NDEBUG
+    checkUnchanged();
+#endif
+    return cachedDigest;
+}
+
+std::string Move::toString() const
+{
+    if (!sealed)
+        return describe();
+#ifndef NDEBUG
+    checkUnchanged();
+#endif
+    return cachedString;
+}
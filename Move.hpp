@@ -2,22 +2,54 @@
 #define MOVE_HPP
 
 #include <string>
+#include "Sha256.hpp"
+#include "ChessMove.hpp"
+#include "KeyCache.hpp"
+#include "SignatureScheme.hpp"
 
 class Move
 {
+private:
+    // Filled by seal(); a move is immutable once signed
+    bool sealed = false;
+    std::string cachedCanonical;
+    std::string cachedString;
+    Sha256::Digest cachedDigest{};
+
+    std::string signedMessage() const;
+    std::string encodeCanonical() const;
+    std::string describe() const;
+    void checkUnchanged() const;
+
 public:
-    std::string sender;
-    std::string receiver;
-    std::string data;
+    Address sender;
+    Address receiver;
+    ChessMove chessMove;
     int id;
     std::string signature;
+    SignatureAlgorithm scheme = SignatureAlgorithm::RSA2048; // Set from the signing key
 
-    Move(std::string sender, std::string receiver, std::string data);
+    Move(const Address &sender, const Address &receiver, ChessMove chessMove);
 
     void signTransaction(const std::string &privateKey);
+    void signTransaction(EVP_PKEY *privateKey);
 
+    // Consults SignatureCache first and records successful checks in it
     bool isValid() const;
+    // SHA-256 of the scheme, signed message and signature, recomputed from the fields on
+    // every call; the SignatureCache key, so a move changed after sealing never hits it
+    Sha256::Digest verificationDigest() const;
+    // Always performs the public key operation
+    bool verifySignature() const;
+
+    // Caches the canonical bytes, digest and string form; signTransaction calls it
+    void seal();
+    bool isSealed() const;
 
+    // Id, scheme, sender and receiver addresses, the packed 16-bit move, then the length-prefixed signature
+    std::string canonicalBytes() const;
+    // SHA-256 of canonicalBytes(); used for hashing, dedupe and persistence
+    Sha256::Digest digest() const;
     std::string toString() const;
 };
 
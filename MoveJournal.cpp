@@ -0,0 +1,343 @@
+#include "MoveJournal.hpp"
+#include "Bytes.hpp"
+#include "ChainCodec.hpp"
+#include "DurableWriter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+const string MoveJournal::MAGIC = "CCMV";
+
+static string header()
+{
+    string out = MoveJournal::MAGIC;
+    appendUint32(out, MoveJournal::VERSION);
+    return out;
+}
+
+static string readFile(const string &path)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+    {
+        return "";
+    }
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+// Parses records until the end or the first torn one; returns where the intact part ends
+static size_t scan(const string &data, const string &path, vector<MoveJournalEntry> &entries)
+{
+    ByteReader reader(data);
+    if (data.size() < MoveJournal::MAGIC.size() + 4 || reader.readBytes(MoveJournal::MAGIC.size()) != MoveJournal::MAGIC ||
+        reader.readUint32() != MoveJournal::VERSION)
+    {
+        throw runtime_error("Unrecognised move journal " + path);
+    }
+    size_t end = reader.position();
+    while (!reader.done())
+    {
+        try
+        {
+            uint32_t length = reader.readUint32();
+            uint32_t checksum = reader.readUint32();
+            string_view payload = reader.readView(length);
+            if (crc32(payload.data(), payload.size()) != checksum)
+            {
+                break;
+            }
+            ByteReader record(payload);
+            MoveJournalEntry entry;
+            entry.timestamp = record.readUint64();
+            entry.sequence = record.readUint64();
+            entry.record = string(payload.substr(record.position()));
+            entries.push_back(move(entry));
+        }
+        catch (const runtime_error &)
+        {
+            break;
+        }
+        end = reader.position();
+    }
+    return end;
+}
+
+MoveJournal::MoveJournal(const string &basePath) : path(basePath + ".journal")
+{
+    string data = readFile(path);
+    if (data.empty())
+    {
+        out.open(path, ios::binary | ios::trunc);
+        string start = header();
+        out.write(start.data(), start.size());
+        out.flush();
+        if (!out)
+        {
+            throw runtime_error("Failed to open " + path + " for writing.");
+        }
+        DurableWriter::instance().commit(path, FileClass::Games, true);
+        fileSize = start.size();
+    }
+    else
+    {
+        vector<MoveJournalEntry> entries;
+        size_t end = scan(data, path, entries);
+        if (!entries.empty())
+        {
+            nextSequence = entries.back().sequence + 1;
+            lastTimestamp = entries.back().timestamp;
+        }
+        if (end < data.size() && truncate(path.c_str(), (off_t)end) != 0)
+        {
+            throw runtime_error("Failed to truncate damaged tail of " + path);
+        }
+        fileSize = end;
+        out.open(path, ios::binary | ios::app);
+        if (!out)
+        {
+            throw runtime_error("Failed to open " + path + " for writing.");
+        }
+    }
+    MoveJournalFlusher::instance().add(this);
+}
+
+void MoveJournal::append(const Move &move)
+{
+    string record = ChainCodec::encodeMove(move);
+    {
+        lock_guard<mutex> lock(mtx);
+        // Read under the lock and clamped, so a concurrent append or a clock step back can't
+        // give a later sequence number an earlier time; mergeMoves relies on that order
+        uint64_t now = (uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        uint64_t timestamp = max(now, lastTimestamp);
+        lastTimestamp = timestamp;
+        string payload;
+        payload.reserve(16 + record.size());
+        appendUint64(payload, timestamp);
+        appendUint64(payload, nextSequence++);
+        payload.append(record);
+
+        appendUint32(buffer, (uint32_t)payload.size());
+        appendUint32(buffer, crc32(payload));
+        buffer.append(payload);
+        buffered++;
+    }
+    MoveJournalFlusher::instance().recordAppend();
+}
+
+size_t MoveJournal::write()
+{
+    lock_guard<mutex> fileLock(mtxFile);
+    string pending;
+    size_t count;
+    {
+        lock_guard<mutex> lock(mtx);
+        pending.swap(buffer);
+        count = buffered;
+        buffered = 0;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    out.write(pending.data(), pending.size());
+    out.flush();
+    if (!out)
+    {
+        // Drop whatever part reached the file and put the moves back in front of newer ones
+        out.close();
+        bool trimmed = truncate(path.c_str(), (off_t)fileSize) == 0;
+        out.open(path, ios::binary | ios::app);
+        {
+            lock_guard<mutex> lock(mtx);
+            buffer.insert(0, pending);
+            buffered += count;
+        }
+        throw runtime_error("Failed to append to " + path + (trimmed ? "" : " (partial record left behind)"));
+    }
+    fileSize += pending.size();
+    return count;
+}
+
+size_t MoveJournal::flush()
+{
+    size_t count = write();
+    if (count > 0)
+    {
+        DurableWriter::instance().commit(path, FileClass::Games);
+        MoveJournalFlusher::instance().recordFlush(count);
+    }
+    return count;
+}
+
+const string &MoveJournal::getPath() const
+{
+    return path;
+}
+
+vector<MoveJournalEntry> MoveJournal::read(const string &path)
+{
+    string data = readFile(path);
+    vector<MoveJournalEntry> entries;
+    if (!data.empty())
+    {
+        scan(data, path, entries);
+    }
+    return entries;
+}
+
+MoveJournal::~MoveJournal()
+{
+    MoveJournalFlusher::instance().remove(this);
+    try
+    {
+        flush();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+    }
+}
+
+MoveJournalFlusher &MoveJournalFlusher::instance()
+{
+    static MoveJournalFlusher flusher;
+    return flusher;
+}
+
+void MoveJournalFlusher::add(MoveJournal *journal)
+{
+    lock_guard<mutex> lock(mtx);
+    journals.push_back(journal);
+    if (!running)
+    {
+        running = true;
+        flusher = thread(&MoveJournalFlusher::flushLoop, this);
+    }
+}
+
+void MoveJournalFlusher::remove(MoveJournal *journal)
+{
+    unique_lock<mutex> lock(mtx);
+    journals.erase(std::remove(journals.begin(), journals.end(), journal), journals.end());
+    idle.wait(lock, [this]
+              { return activeRounds == 0; });
+}
+
+void MoveJournalFlusher::flushRound()
+{
+    vector<MoveJournal *> snapshot;
+    {
+        lock_guard<mutex> lock(mtx);
+        snapshot = journals;
+        activeRounds++;
+    }
+
+    vector<string> paths;
+    vector<size_t> counts;
+    for (auto *journal : snapshot)
+    {
+        try
+        {
+            size_t count = journal->write();
+            if (count > 0)
+            {
+                paths.push_back(journal->getPath());
+                counts.push_back(count);
+            }
+        }
+        catch (const exception &e)
+        {
+            cerr << "Error: " << e.what() << endl;
+        }
+    }
+    try
+    {
+        DurableWriter::instance().commit(paths, FileClass::Games);
+        for (size_t count : counts)
+        {
+            recordFlush(count);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+    }
+
+    {
+        lock_guard<mutex> lock(mtx);
+        activeRounds--;
+    }
+    idle.notify_all();
+}
+
+void MoveJournalFlusher::flushAll()
+{
+    flushRound();
+}
+
+void MoveJournalFlusher::flushLoop()
+{
+    while (true)
+    {
+        bool stopping;
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait_for(lock, chrono::milliseconds(FLUSH_INTERVAL_MS), [this]
+                        { return !running; });
+            stopping = !running;
+        }
+        flushRound();
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+void MoveJournalFlusher::stop()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        if (!running)
+        {
+            return;
+        }
+        running = false;
+    }
+    cv.notify_all();
+    flusher.join();
+}
+
+void MoveJournalFlusher::recordAppend()
+{
+    appended.fetch_add(1, memory_order_relaxed);
+}
+
+void MoveJournalFlusher::recordFlush(size_t moves)
+{
+    written.fetch_add(moves, memory_order_relaxed);
+    flushes.fetch_add(1, memory_order_relaxed);
+}
+
+MoveJournalStats MoveJournalFlusher::stats() const
+{
+    MoveJournalStats out;
+    out.appended = appended.load();
+    out.written = written.load();
+    out.flushes = flushes.load();
+    return out;
+}
+
+MoveJournalFlusher::~MoveJournalFlusher()
+{
+    stop();
+}
@@ -0,0 +1,112 @@
+#ifndef MOVEJOURNAL_HPP
+#define MOVEJOURNAL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Move.hpp"
+
+struct MoveJournalEntry
+{
+    uint64_t timestamp = 0; // Microseconds since the epoch, when the move was created
+    uint64_t sequence = 0;  // Position in its journal, from 0
+    std::string record;     // ChainCodec move record
+};
+
+struct MoveJournalStats
+{
+    uint64_t appended = 0; // Moves handed to append()
+    uint64_t written = 0;  // Moves that reached a file
+    uint64_t flushes = 0;  // Buffer writes that were committed
+};
+
+// Append-only record of the moves one player created, kept in <base>.journal so players
+// never share a file. A magic/version header is followed by [u32 length][u32 CRC-32]
+// [payload] records, the payload being a u64 timestamp, a u64 sequence number and the
+// move record. append() only adds to an in-memory buffer; MoveJournalFlusher writes the
+// buffers out in the background. Opening an existing journal continues its numbering
+// and cuts off a torn last record.
+class MoveJournal
+{
+private:
+    std::string path;
+    std::mutex mtx; // Guards buffer, counts, nextSequence and lastTimestamp
+    std::string buffer;
+    size_t buffered = 0;
+    uint64_t nextSequence = 0;
+    uint64_t lastTimestamp = 0; // Timestamps never go below it, so sequence order is time order
+    std::mutex mtxFile; // One write at a time
+    std::ofstream out;
+    uint64_t fileSize = 0; // End of the last complete write
+
+public:
+    static const std::string MAGIC;
+    static const uint32_t VERSION = 1;
+
+    explicit MoveJournal(const std::string &basePath);
+    MoveJournal(const MoveJournal &) = delete;
+    MoveJournal &operator=(const MoveJournal &) = delete;
+
+    void append(const Move &move);
+    // Writes what is buffered without committing it; returns the number of moves written.
+    // If the write fails the partial tail is cut off and the moves stay buffered.
+    size_t write();
+    // write() followed by a durable commit
+    size_t flush();
+    const std::string &getPath() const;
+
+    // Every intact record, in file order; throws runtime_error if the file is not a move journal
+    static std::vector<MoveJournalEntry> read(const std::string &path);
+
+    // Flushes what is left
+    ~MoveJournal();
+};
+
+// Process-wide background writer for move journals. Journals register when they open and
+// leave when they are destroyed; a single thread, started with the first journal, writes
+// every registered buffer each FLUSH_INTERVAL and then commits them in one group round.
+// The list is only locked long enough to copy it, so add() never waits on disk.
+class MoveJournalFlusher
+{
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::condition_variable idle; // Signalled when a flush round ends
+    std::vector<MoveJournal *> journals;
+    int activeRounds = 0;
+    std::thread flusher;
+    bool running = false;
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> flushes{0};
+    std::atomic<uint64_t> appended{0};
+
+    MoveJournalFlusher() = default;
+    void flushLoop();
+    void flushRound();
+
+public:
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    static MoveJournalFlusher &instance();
+
+    void add(MoveJournal *journal);
+    // Also waits for a round in progress, which may still be using the journal
+    void remove(MoveJournal *journal);
+    // Flushes every registered journal now and waits for it
+    void flushAll();
+    // Final flush, then stops the thread; journals opened later start it again
+    void stop();
+
+    void recordAppend();
+    void recordFlush(size_t moves);
+    MoveJournalStats stats() const;
+
+    ~MoveJournalFlusher();
+};
+
+#endif
@@ -1,4 +1,9 @@
 #include "Player.hpp"
+#include "BatchVerifier.hpp"
+#include "KeyPool.hpp"
+#include "ChainCodec.hpp"
+#include "Bytes.hpp"
+#include "DurableWriter.hpp"
 #include <fstream>
 #include <algorithm>
 #include <nlohmann/json.hpp>
@@ -15,102 +20,70 @@
 using namespace std;
 using json = nlohmann::json;
 
+// The message expression is only evaluated when this player's level lets it through
+#define NODE_LOG(level, message) LOG_AT(level, logLevel, nodeId, message)
+
 void Player::generateKeyPair()
 {
-    // Use OpenSSL to generate an actual public-private key pair
-    EVP_PKEY *pkey = EVP_PKEY_new();
-    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
-
-    if (!ctx || !pkey)
-    {
-        throw runtime_error("Failed to initialize OpenSSL context.");
-    }
-
-    if (EVP_PKEY_keygen_init(ctx) <= 0)
-    {
-        EVP_PKEY_CTX_free(ctx);
-        throw runtime_error("Failed to initialize key generation.");
-    }
-
-    if (EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, 2048) <= 0)
-    {
-        EVP_PKEY_CTX_free(ctx);
-        throw runtime_error("Failed to set RSA key size.");
-    }
-
-    if (EVP_PKEY_keygen(ctx, &pkey) <= 0)
-    {
-        EVP_PKEY_CTX_free(ctx);
-        throw runtime_error("Key generation failed.");
-    }
-
-    EVP_PKEY_CTX_free(ctx);
-
-    // Extract private key
-    BIO *privateKeyBio = BIO_new(BIO_s_mem());
-    if (!PEM_write_bio_PrivateKey(privateKeyBio, pkey, NULL, NULL, 0, NULL, NULL))
-    {
-        EVP_PKEY_free(pkey);
-        BIO_free(privateKeyBio);
-        throw runtime_error("Failed to write private key.");
-    }
+    // Key type follows SignatureScheme::defaultAlgorithm(); RSA-2048 unless configured otherwise.
+    // Taken from the background pool when it has one ready.
+    useKey(KeyPool::instance().acquire(SignatureScheme::defaultAlgorithm()));
+}
 
-    char *privateKeyData;
-    long privateKeyLen = BIO_get_mem_data(privateKeyBio, &privateKeyData);
-    privateKey = string(privateKeyData, privateKeyLen);
-    BIO_free(privateKeyBio);
+void Player::useKey(const KeyHandle &key)
+{
+    signingKey = key;
+    privateKey = SignatureScheme::privateKeyPem(signingKey.get());
+    publicKey = SignatureScheme::publicKeyPem(signingKey.get());
+}
 
-    // Extract public key
-    BIO *publicKeyBio = BIO_new(BIO_s_mem());
-    if (!PEM_write_bio_PUBKEY(publicKeyBio, pkey))
-    {
-        EVP_PKEY_free(pkey);
-        BIO_free(publicKeyBio);
-        throw runtime_error("Failed to write public key.");
-    }
+Player::Player() : blockchain(*(new Game()))
+{
+    generateKeyPair();
+    initialize();
+}
 
-    char *publicKeyData;
-    long publicKeyLen = BIO_get_mem_data(publicKeyBio, &publicKeyData);
-    publicKey = string(publicKeyData, publicKeyLen);
-    BIO_free(publicKeyBio);
+Player::Player(const KeyRecord &record) : blockchain(*(new Game()))
+{
+    useKey(record.key);
+    initialize();
+}
 
-    EVP_PKEY_free(pkey);
+KeyRecord Player::keyRecord() const
+{
+    KeyRecord record;
+    record.algorithm = SignatureScheme::algorithmOf(signingKey.get());
+    record.key = signingKey;
+    return record;
 }
 
-Player::Player(int diff) : difficulty(diff), blockchain(*(new Game()))
+void Player::initialize()
 {
     opponent = nullptr;
-    generateKeyPair();
-    string sanitizedPublicKey = publicKey;
-    sanitizedPublicKey.erase(remove(sanitizedPublicKey.begin(), sanitizedPublicKey.end(), '\n'), sanitizedPublicKey.end());
-    nodeId = sanitizedPublicKey.substr(sanitizedPublicKey.size() - 40);
-    logMessage("Node " + nodeId + " started");
-
-    // Initialize {nodeId}_mempool.json with an empty array
-    string mempoolFilename = "./data/" + nodeId + "_mempool.json";
-    ifstream mempoolCheckFile(mempoolFilename);
-    ofstream mempoolInitFile(mempoolFilename);
-    if (mempoolInitFile.is_open())
-    {
-        mempoolInitFile << "[]"; // Initialize with an empty array
-        mempoolInitFile.close();
-    }
-    // Initialize {nodeId}_blockchain.json with an empty array
-    string filename = "./data/" + nodeId + "_blockchain.json";
-    ofstream blockchainInitFile(filename);
-    if (blockchainInitFile.is_open())
+    address = KeyCache::instance().registerKey(publicKey);
+    nodeId = address.toHex();
+    logLevel = Logger::instance().levelFor(nodeId);
+    NODE_LOG(LogLevel::Info, "Node " + nodeId + " started");
+
+    // Replay moves still pending from an earlier run
+    mempool.reset(new MempoolJournal("./data/" + nodeId + "_mempool"));
+    createdMoves.reset(new MoveJournal("./data/" + nodeId + "_moves"));
+    for (const auto &entry : mempool->contents())
     {
-        blockchainInitFile << "[]"; // Initialize with an empty array
-        blockchainInitFile.close();
+        try
+        {
+            transactionQueue.push(ChainCodec::decodeMove(entry));
+        }
+        catch (const exception &e)
+        {
+            NODE_LOG(LogLevel::Warn, "Dropped unreadable mempool entry on Node " + nodeId + ": " + e.what());
+        }
     }
 }
 
-void Player::createMove(string data)
+void Player::createMove(const string &uci)
 {
-    if (data.size() <= 0)
-    {
-        throw invalid_argument("Data must not be empty");
-    }
+    ChessMove chessMove = ChessMove::fromUci(uci);
 
     if (this->opponent == nullptr)
     {
@@ -118,124 +91,32 @@ void Player::createMove(string data)
         return;
     }
 
-    Move transaction(publicKey, this->opponent->publicKey, data);
+    Move transaction(address, this->opponent->address, chessMove);
 
-    transaction.signTransaction(privateKey);
+    transaction.signTransaction(signingKey.get());
     if (!transaction.isValid())
     {
         throw runtime_error("Transaction signature is invalid.");
     }
 
-    // Sanitize sender and recipient addresses
-    string sanitizedSender = transaction.sender;
-    sanitizedSender.erase(remove(sanitizedSender.begin(), sanitizedSender.end(), '\n'), sanitizedSender.end());
-
-    string sanitizedRecipient = transaction.receiver;
-    sanitizedRecipient.erase(remove(sanitizedRecipient.begin(), sanitizedRecipient.end(), '\n'), sanitizedRecipient.end());
-
-    // Read the existing transactions from createdTransaction.json
-    ifstream inputFile("createdMove.json");
-    json transactions = json::array();
-
-    std::cout << "Reading existing transactions from createdMove.json..." << std::endl;
-
-    if (inputFile.is_open())
-    {
-        try
-        {
-            inputFile >> transactions;
-        }
-        catch (const json::parse_error &e)
-        {
-            cerr << "Error parsing JSON: " << e.what() << endl;
-        }
-        inputFile.close();
-    }
-
-    // Append the new transaction
-    json newTransaction = {
-        {"id", transaction.id},
-        {"sender", sanitizedSender},
-        {"recipient", sanitizedRecipient},
-        {"data", transaction.data}};
-
-    transactions.push_back(newTransaction);
-
-    // Write the updated transactions back to createdTransaction.json
-    ofstream outputFile("createdMove.json", ios::trunc);
-    if (!outputFile.is_open())
-    {
-        throw runtime_error("Failed to open createdMove.json for writing.");
-    }
-
-    outputFile << transactions.dump(4); // Pretty print with 4 spaces
-
-    std::cout << "move added" << endl;
-    outputFile.close();
+    // Buffered; the journal flusher writes it out in the background
+    createdMoves->append(transaction);
 
     this->addMove(transaction);
 
-    logMessage("Transaction added: " + transaction.toString());
+    NODE_LOG(LogLevel::Info, "Transaction added: " + transaction.toString());
 }
 
 bool Player::gameStrated(Player &opponent, Game &newChain)
 {
     if (this->opponent == nullptr && &opponent != nullptr)
     {
-        logMessage("Game started" + newChain.toString());
+        NODE_LOG(LogLevel::Info, "Game started" + newChain.toString());
         this->opponent = &opponent;
         this->blockchain = newChain;
         this->connectPeer(ref(opponent));
 
-        string filename = "./data/" + nodeId + "_blockchain.json";
-
-        // Add the genesis block to {nodeId}_blockchain.json
-        ifstream checkFile(filename);
-        if (checkFile.peek() == ifstream::traits_type::eof())
-        {
-            ofstream initFile(filename);
-            if (initFile.is_open())
-            {
-                initFile << "[]"; // Initialize with an empty array
-                initFile.close();
-            }
-        }
-
-        json blockchainJson = json::array();
-        ifstream inputFile(filename);
-        if (inputFile.is_open())
-        {
-            try
-            {
-                inputFile >> blockchainJson;
-            }
-            catch (const json::parse_error &e)
-            {
-                cerr << "Error parsing JSON 1: " << e.what() << endl;
-            }
-            inputFile.close();
-        }
-
-        BlockGame genesisBlock = blockchain.getChain().front();
-        json blockJson = {
-            {"index", genesisBlock.index},
-            {"previousHash", genesisBlock.previousHash},
-            {"hash", genesisBlock.hash},
-            {"timestamp", genesisBlock.timestamp},
-            {"moves", json::array()},
-            {"nonce", genesisBlock.nonce},
-            {"gameId", blockchain.gameId}};
-
-        blockchainJson.push_back(blockJson);
-
-        ofstream outputFile(filename, ios::trunc);
-        if (!outputFile.is_open())
-        {
-            throw runtime_error("Failed to open " + filename + " for writing.");
-        }
-
-        outputFile << blockchainJson.dump(4); // Pretty print with 4 spaces
-        outputFile.close();
+        saveBlockchainFile();
         return true;
     }
     else if (this->opponent != nullptr && &opponent == nullptr)
@@ -245,53 +126,11 @@ bool Player::gameStrated(Player &opponent, Game &newChain)
     }
 }
 
-void Player::logMessage(const string &message)
-{
-    ifstream inputFile("logs.json");
-    json logs = json::array();
-
-    std::cout << "Logging message: " << message << endl;
-
-    // Read existing logs from the file
-
-    if (inputFile.is_open())
-    {
-        try
-        {
-            inputFile >> logs;
-        }
-        catch (const json::parse_error &e)
-        {
-            cerr << "Error parsing JSON 2: " << e.what() << endl;
-        }
-        inputFile.close();
-    }
-
-    // Add the new log entry
-    json logEntry = {
-        {"timestamp", chrono::duration_cast<chrono::seconds>(
-                          chrono::system_clock::now().time_since_epoch())
-                          .count()},
-        {"message", message}};
-    logs.push_back(logEntry);
-
-    // Write back to the file
-    ofstream outputFile("logs.json", ios::trunc);
-    if (!outputFile.is_open())
-    {
-        throw runtime_error("Failed to open createdTransaction.json for writing.");
-    }
-
-    outputFile << logs.dump(4); // Pretty print with 4 spaces
-
-    outputFile.close();
-}
-
 bool Player::isValidMove(const Move &txn)
 {
-    if (txn.data.size() <= 0)
+    if (!txn.chessMove.isValid())
         return false;
-    if (txn.sender.empty() || txn.receiver.empty())
+    if (txn.sender.isZero() || txn.receiver.isZero())
         return false;
     // ADD MORE CHECKS ON MOVES
     return true;
@@ -322,52 +161,7 @@ void Player::sendCompleteGame()
 
                 completeGames.pop();
 
-                // Remove the game from {nodeId}_completeGames.json
-                string filename = "./data/" + nodeId + "_completeGames.json";
-                json completeGamesJson = json::array();
-
-                ifstream inFile(filename);
-                if (inFile.is_open())
-                {
-                    try
-                    {
-                        inFile >> completeGamesJson;
-                    }
-                    catch (const json::parse_error &e)
-                    {
-                        cerr << "Error parsing JSON: " << e.what() << endl;
-                    }
-                    inFile.close();
-                }
-
-                // Find and remove the game from the JSON array
-                auto it = remove_if(completeGamesJson.begin(), completeGamesJson.end(),
-                                    [&tempGame](const json &gameJson)
-                                    {
-                                        int index = 0;
-                                        for (auto &blockJson : gameJson)
-                                        {
-                                            if (!(blockJson["index"] == tempGame.getChain()[index].index &&
-                                                  blockJson["previousHash"] == tempGame.getChain()[index].previousHash &&
-                                                  blockJson["hash"] == tempGame.getChain()[index].hash &&
-                                                  blockJson["timestamp"] == tempGame.getChain()[index].timestamp &&
-                                                  blockJson["nonce"] == tempGame.getChain()[index].nonce))
-                                            {
-                                                return false;
-                                            }
-                                            index++;
-                                        }
-                                        return true;
-                                    });
-
-                completeGamesJson.erase(it, completeGamesJson.end());
-
-                ofstream outFile(filename, ios::trunc);
-                if (outFile.is_open())
-                {
-                    outFile << completeGamesJson.dump(4); // Pretty print with 4 spaces
-                    outFile.close();
-                }
+                saveCompleteGamesFile();
             }
             catch (const exception &e)
             {
@@ -383,18 +177,12 @@ void Player::mineBlock()
     {
         if (blockchain.getChain().size() == 3)
         {
-            logMessage("Game ended " + blockchain.toString());
+            NODE_LOG(LogLevel::Info, "Game ended " + blockchain.toString());
             blockchain.endGame();
             this->addCompleteGame(blockchain);
             blockchain = *(new Game());
             opponent = nullptr;
-            string filename = "./data/" + nodeId + "_blockchain.json";
-            ofstream blockchainInitFile(filename);
-            if (blockchainInitFile.is_open())
-            {
-                blockchainInitFile << "[]"; // Initialize with an empty array
-                blockchainInitFile.close();
-            }
+            saveBlockchainFile();
         }
         sendCompleteGame();
         try
@@ -404,7 +192,7 @@ void Player::mineBlock()
                     { return !running || transactionQueue.size() >= 5; });
 
             std::cout << "============================================" << endl;
-            logMessage("Mining block..." + this->nodeId + " transactions in queue");
+            NODE_LOG(LogLevel::Info, "Mining block..." + this->nodeId + " transactions in queue");
 
             if (!running)
                 return;
@@ -415,115 +203,71 @@ void Player::mineBlock()
                 transactions.push_back(transactionQueue.front());
                 transactionQueue.pop();
             }
-            mtx.unlock();
+            lock.unlock();
 
-            BlockGame newBlock(blockchain.getChain().size(), blockchain.getLastBlock().hash, transactions);
-            newBlock.mineBlock(difficulty);
-
-            if (verifyNewBlock(newBlock))
+            // Register the job before reading the tip so a block accepted in between still cancels it
+            auto job = make_shared<MiningJob>();
             {
-                std::cout << "Valid block mined Broadcating" << endl;
-                broadcastBlock(newBlock, "0");
-                std::cout << "here mining" << endl;
+                lock_guard<mutex> jobLock(mtxJob);
+                currentJob = job;
             }
-            else
+            BlockGame newBlock(blockchain.getChain().size(), blockchain.getLastBlock().hash, transactions);
+            int required = blockchain.requiredDifficulty(newBlock.index);
+            MiningResult mined = newBlock.mineBlock(required, job.get());
+            uint64_t searched = mined.hashes;
+            // Running out of nonces is not a stale tip; a new timestamp gives a fresh header to search
+            while (!mined.found && !mined.cancelled && running)
             {
-                std::cout << "Invalid block mined by Node " << nodeId << endl;
-                continue;
+                NODE_LOG(LogLevel::Warn, "Node " + nodeId + " exhausted the nonce range, retrying with a new timestamp");
+                newBlock.timestamp = max(newBlock.timestamp + 1, (long)time(nullptr));
+                mined = newBlock.mineBlock(required, job.get());
+                searched += mined.hashes;
             }
-
-            blockchain.addBlock(newBlock);
-            string filename = "./data/" + nodeId + "_blockchain.json";
-            ifstream checkFile(filename);
-            if (checkFile.peek() == ifstream::traits_type::eof())
             {
-                ofstream initFile(filename);
-                if (initFile.is_open())
-                {
-                    initFile << "[]"; // Initialize with an empty array
-                    initFile.close();
-                }
+                lock_guard<mutex> jobLock(mtxJob);
+                currentJob.reset();
             }
-            json blockchainJson = json::array();
+            NODE_LOG(LogLevel::Debug, "Node " + nodeId + " searched " + to_string(mined.hashes) + " nonces in " +
+                       to_string(mined.seconds) + "s (" + to_string((long long)mined.hashesPerSecond()) + " H/s)");
 
-            ifstream inputFile(filename);
-            if (inputFile.is_open())
+            if (!mined.found)
             {
-                try
-                {
-                    inputFile >> blockchainJson;
-                }
-                catch (const json::parse_error &e)
+                if (!mined.cancelled)
                 {
-                    cerr << "Error parsing JSON 3: " << e.what() << endl;
+                    continue; // Shutting down
                 }
-                inputFile.close();
+                wastedHashes += searched;
+                requeueDisplaced(transactions, newBlock.index);
+                NODE_LOG(LogLevel::Warn, "Node " + nodeId + " abandoned stale block, wasted hashes so far: " + to_string(wastedHashes));
+                continue;
             }
 
-            json blockJson = {
-                {"index", newBlock.index},
-                {"previousHash", newBlock.previousHash},
-                {"hash", newBlock.hash},
-                {"timestamp", newBlock.timestamp},
-                {"moves", json::array()},
-                {"nonce", newBlock.nonce},
-                {"gameId", blockchain.gameId}};
-
-            for (const auto &txn : newBlock.moves)
+            if (verifyNewBlock(newBlock))
             {
-                blockJson["moves"].push_back({{"id", txn.id}, {"sender", txn.sender}, {"receiver", txn.receiver}, {"amount", txn.data}});
+                std::cout << "Valid block mined Broadcating" << endl;
+                broadcastBlock(newBlock, "0");
+                std::cout << "here mining" << endl;
             }
-
-            blockchainJson.push_back(blockJson);
-
-            ofstream outputFile(filename);
-            if (!outputFile.is_open())
+            else
             {
-                throw runtime_error("Failed to open createdMoves.json for writing.");
+                std::cout << "Invalid block mined by Node " << nodeId << endl;
+                wastedHashes += searched;
+                requeueDisplaced(transactions, newBlock.index);
+                continue;
             }
 
-            outputFile << blockchainJson.dump(4); // Pretty print with 4 spaces
-
+            blockchain.addBlock(newBlock);
+            saveBlockchainFile();
             std::cout << "block added" << endl;
-            outputFile.close();
-
-            string mempoolFilename = "./data/" + nodeId + "_mempool.json";
-            json mempool = json::array(); // Initialize as an array
-
-            ifstream mempoolInFile(mempoolFilename);
-            if (mempoolInFile.is_open())
-            {
-                std::cout << "opened" << endl;
-                mempoolInFile >> mempool;
-                mempoolInFile.close();
-            }
 
-            std::cout << mempool.size() << endl;
             std::cout << "Deleting from mempool" << endl;
-            for (const auto &txn : transactions)
-            {
-                auto it = remove_if(mempool.begin(), mempool.end(),
-                                    [&txn](const json &mempoolTxn)
-                                    {
-                                        return mempoolTxn["id"] == txn.id &&
-                                               mempoolTxn["sender"] == txn.sender &&
-                                               mempoolTxn["receiver"] == txn.receiver &&
-                                               mempoolTxn["data"] == txn.data;
-                                    });
-                mempool.erase(it, mempool.end());
-            }
-
-            ofstream mempoolOutFile(mempoolFilename);
-            if (mempoolOutFile.is_open())
-            {
-                mempoolOutFile << mempool.dump(4); // Pretty print with 4 spaces
-                mempoolOutFile.close();
-            }
+            updateMempoolFile(transactions);
 
-            logMessage("Block mined by Node " + nodeId + ": " + newBlock.hash);
+            NODE_LOG(LogLevel::Info, "Block mined by Node " + nodeId + ": " + newBlock.hash.toHex());
 
             std::cout << "Block mined by Node " << nodeId << ": " << newBlock.hash << endl;
 
+            lock.lock();
             cv.wait_for(lock, chrono::seconds(2));
 
             std::cout
@@ -537,7 +281,7 @@ void Player::mineBlock()
     }
 }
 
-bool Player::verifyValidGame(const Game &game)
+bool Player::verifyValidGame(const Game &game, size_t fromHeight)
 {
     // Verify that the game has a valid chain of blocks
     const auto &chain = game.getChain();
@@ -551,24 +295,53 @@ bool Player::verifyValidGame(const Game &game)
         {
             return false;
         }
+        if (i < fromHeight)
+        {
+            continue; // Already validated; the link above is all that can have changed
+        }
 
-        // Check if the block's hash meets the difficulty criteria
-        string target(currentBlock.difficulty, '0');
-        if (currentBlock.hash.substr(0, currentBlock.difficulty) != target)
+        // Check the hash commits to the block and meets the difficulty the game chain requires at this height
+        if (!currentBlock.merkleRootMatches() || currentBlock.calculateHash(currentBlock.nonce) != currentBlock.hash ||
+            !Miner::meetsTarget(currentBlock.hash, game.requiredDifficulty(i)))
         {
             return false;
         }
 
-        // Verify the integrity of the block's transactions
         for (const auto &txn : currentBlock.moves)
         {
-            if (!isValidMove(txn) || !txn.isValid())
+            if (!isValidMove(txn))
             {
                 return false;
             }
         }
     }
 
+    // Verify every move signature in one batch, spread over the shared pool
+    BatchResult signatures;
+    if (fromHeight <= 1)
+    {
+        signatures = BatchVerifier().verify(game);
+    }
+    else
+    {
+        vector<const Move *> moves;
+        for (size_t i = fromHeight; i < chain.size(); i++)
+        {
+            for (const auto &txn : chain[i].moves)
+            {
+                moves.push_back(&txn);
+            }
+        }
+        signatures = BatchVerifier().verify(moves);
+    }
+    NODE_LOG(LogLevel::Debug, "Node " + nodeId + " verified " + to_string(signatures.checked) + "/" +
+               to_string(signatures.total) + " signatures (" + to_string(signatures.cached) + " cached) of game " + to_string(game.gameId) + " in " +
+               to_string(signatures.seconds * 1000.0) + " ms on " + to_string(signatures.workers) + " threads");
+    if (!signatures.valid)
+    {
+        return false;
+    }
+
     // Additional checks can be added here, such as verifying the game's winner or rules
     return true;
 }
@@ -578,65 +351,90 @@ void Player::addCompleteGame(const Game &game)
     if (verifyValidGame(game))
     {
         completeGames.push(game);
+        saveCompleteGamesFile();
+    }
+    else
+        cerr << "Invalid game data. Cannot add to complete games." << endl;
+}
 
-        string filename = "./data/" + nodeId + "_completeGames.json";
-        ifstream checkFile(filename);
-        if (checkFile.peek() == ifstream::traits_type::eof())
-        {
-            ofstream initFile(filename);
-            if (initFile.is_open())
-            {
-                initFile << "[]"; // Initialize with an empty array
-                initFile.close();
-            }
-        }
-
-        json completeGamesJson = json::array();
-
-        ifstream inFile(filename);
-        if (inFile.is_open())
-        {
-            try
-            {
-                inFile >> completeGamesJson;
-            }
-            catch (const json::parse_error &e)
-            {
-                cerr << "Error parsing JSON: " << e.what() << endl;
-            }
-            inFile.close();
-        }
+// Both state files are rebuilt from memory and replaced whole, so a crash leaves the
+// previous version rather than a torn one that needs parsing around. They hold signed
+// ChainCodec records; ChainExport::exportGames turns them into JSON for the viewer.
+void Player::saveBlockchainFile()
+{
+    DurableWriter::instance().replace("./data/" + nodeId + "_game.dat", ChainCodec::encodeGame(blockchain), FileClass::Blockchain);
+}
 
-        json gameJson = json::array();
-        for (const auto &block : game.getChain())
-        {
-            json blockJson = {
-                {"index", block.index},
-                {"previousHash", block.previousHash},
-                {"hash", block.hash},
-                {"timestamp", block.timestamp},
-                {"moves", json::array()},
-                {"nonce", block.nonce}};
-
-            for (const auto &txn : block.moves)
-            {
-                blockJson["moves"].push_back({{"id", txn.id}, {"sender", txn.sender}, {"receiver", txn.receiver}, {"data", txn.data}});
-            }
+bool Player::loadSavedGame(Game &game)
+{
+    ifstream in("./data/" + nodeId + "_game.dat", ios::binary);
+    if (!in.is_open())
+    {
+        return false;
+    }
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    try
+    {
+        game = ChainCodec::decodeGame(data);
+    }
+    catch (const exception &e)
+    {
+        NODE_LOG(LogLevel::Warn, "Node " + nodeId + " cannot read its saved game: " + e.what());
+        return false;
+    }
+    if (game.gameComplete || find(game.players.begin(), game.players.end(), address) == game.players.end())
+    {
+        return false;
+    }
 
-            gameJson.push_back(blockJson);
-        }
+    vector<Hash256> hashes;
+    for (const auto &block : game.getChain())
+    {
+        hashes.push_back(block.hash);
+    }
+    size_t trusted = 0;
+    try
+    {
+        const CheckpointEntry *entry = Checkpoint::load().find(nodeId);
+        trusted = entry ? entry->trustedHeight(hashes) : 0;
+    }
+    catch (const exception &e)
+    {
+        NODE_LOG(LogLevel::Warn, "Node " + nodeId + " ignoring checkpoint: " + e.what());
+    }
+    if (!verifyValidGame(game, max(trusted, (size_t)1)))
+    {
+        NODE_LOG(LogLevel::Warn, "Node " + nodeId + " saved game " + to_string(game.gameId) + " failed validation");
+        return false;
+    }
+    NODE_LOG(LogLevel::Info, "Node " + nodeId + " recovered game " + to_string(game.gameId) + " at height " + to_string(hashes.size()) +
+               " (" + to_string(trusted) + " blocks trusted from checkpoint)");
+    return true;
+}
 
-        completeGamesJson.push_back(gameJson);
+CheckpointEntry Player::checkpoint()
+{
+    CheckpointEntry entry;
+    entry.kind = CheckpointKind::Player;
+    entry.id = nodeId;
+    if (opponent != nullptr)
+    {
+        entry.height = blockchain.getChain().size();
+        entry.tip = blockchain.getLastBlock().hash;
+    }
+    return entry;
+}
 
-        ofstream outFile(filename, ios::trunc);
-        if (outFile.is_open())
-        {
-            outFile << completeGamesJson.dump(4); // Pretty print with 4 spaces
-            outFile.close();
-        }
+void Player::saveCompleteGamesFile()
+{
+    string data;
+    queue<Game> pending = completeGames;
+    while (!pending.empty())
+    {
+        appendString(data, ChainCodec::encodeGame(pending.front()));
+        pending.pop();
     }
-    else
-        cerr << "Invalid game data. Cannot add to complete games." << endl;
+    DurableWriter::instance().replace("./data/" + nodeId + "_completeGames.dat", data, FileClass::Games);
 }
 
 void Player::connectPeer(Player &peer)
@@ -648,11 +446,11 @@ void Player::connectPeer(Player &peer)
     {
         peers.push_back(&peer);
         peer.connectPeer(*this);
-        peer.logMessage("Node " + peer.nodeId + " and Node " + nodeId + " are now connected");
+        LOG_AT(LogLevel::Info, peer.logLevel, peer.nodeId, "Node " + peer.nodeId + " and Node " + nodeId + " are now connected");
     }
     else
     {
-        logMessage("Node " + nodeId + " is already connected to Node " + peer.nodeId);
+        NODE_LOG(LogLevel::Debug, "Node " + nodeId + " is already connected to Node " + peer.nodeId);
     }
 }
 void Player::connectNode(MainNode &peer)
@@ -663,11 +461,11 @@ void Player::connectNode(MainNode &peer)
     if (find(mainNodes.begin(), mainNodes.end(), targetPtr) == mainNodes.end())
     {
         mainNodes.push_back(&peer);
-        this->logMessage("Node " + to_string(peer.nodeId) + " and Player " + nodeId + " are now connected");
+        NODE_LOG(LogLevel::Info, "Node " + to_string(peer.nodeId) + " and Player " + nodeId + " are now connected");
     }
     else
     {
-        logMessage("Player " + nodeId + " is already connected to Node " + to_string(peer.nodeId));
+        NODE_LOG(LogLevel::Debug, "Player " + nodeId + " is already connected to Node " + to_string(peer.nodeId));
     }
 }
 
@@ -675,7 +473,7 @@ void Player::broadcastTransaction(const Move &txn)
 {
     for (auto peer : peers)
     {
-        logMessage("Transaction broadcasted from Node " + nodeId + " to Node " + peer->nodeId);
+        NODE_LOG(LogLevel::Debug, "Transaction broadcasted from Node " + nodeId + " to Node " + peer->nodeId);
         peer->receiveTransaction(txn, this);
     }
 }
@@ -685,7 +483,7 @@ void Player::broadcastTransaction(const Move &txn, Player *speer)
     {
         if (speer->nodeId == peer->nodeId)
             continue;
-        logMessage("Transaction broadcasted from Node " + nodeId + " to Node " + peer->nodeId);
+        NODE_LOG(LogLevel::Debug, "Transaction broadcasted from Node " + nodeId + " to Node " + peer->nodeId);
         peer->receiveTransaction(txn, this);
     }
 }
@@ -701,7 +499,7 @@ void Player::syncPeers()
             {
                 std::cout << "Syncing with peers..." << endl;
                 blockchain = peer->blockchain;
-                logMessage("Node " + nodeId + " synced blockchain with Node " + peer->nodeId);
+                NODE_LOG(LogLevel::Info, "Node " + nodeId + " synced blockchain with Node " + peer->nodeId);
 
                 if (peer->transactionQueue.empty())
                 {
@@ -712,7 +510,7 @@ void Player::syncPeers()
                 queue<Move> tempQueue = peer->transactionQueue;
                 while (!tempQueue.empty())
                 {
-                    auto &txn = tempQueue.front();
+                    Move txn = tempQueue.front();
                     tempQueue.pop();
 
                     bool alreadyExists = false;
@@ -721,23 +519,18 @@ void Player::syncPeers()
                     queue<Move> localQueue = transactionQueue;
                     while (!localQueue.empty())
                     {
-                        const auto &queuedTxn = localQueue.front();
-                        localQueue.pop();
-
-                        if (queuedTxn.id == txn.id &&
-                            queuedTxn.sender == txn.sender &&
-                            queuedTxn.receiver == txn.receiver &&
-                            queuedTxn.data == txn.data)
+                        if (localQueue.front().digest() == txn.digest())
                         {
                             alreadyExists = true;
                             break;
                         }
+                        localQueue.pop();
                     }
 
                     if (!alreadyExists && isValidMove(txn) && txn.isValid())
                     {
                         addMove(txn);
-                        logMessage("Transaction synced from Node " + peer->nodeId + " to Node " + nodeId);
+                        NODE_LOG(LogLevel::Debug, "Transaction synced from Node " + peer->nodeId + " to Node " + nodeId);
                     }
                 }
             }
@@ -753,7 +546,7 @@ void Player::broadcastBlock(const BlockGame &block, string peerId)
             if (peer->nodeId == peerId)
                 continue;
         peer->receiveBlock(block, this);
-        logMessage("Block" + block.hash + "broadcasted from Node " + nodeId + " to Node " + peer->nodeId);
+        NODE_LOG(LogLevel::Debug, "Block" + block.hash.toHex() + "broadcasted from Node " + nodeId + " to Node " + peer->nodeId);
     }
 }
 
@@ -770,20 +563,14 @@ void Player::receiveBlock(const BlockGame &block, Player *peer)
     {
         std::cout << "Valid block received from Node " << peer->nodeId << endl;
         blockchain.addBlock(block);
+        cancelMining(); // Whatever we were mining now builds on a stale tip
         if (blockchain.getChain().size() == 3)
         {
-            logMessage("Game ended " + blockchain.toString());
+            NODE_LOG(LogLevel::Info, "Game ended " + blockchain.toString());
             blockchain.endGame();
             this->addCompleteGame(blockchain);
             blockchain = *(new Game());
             opponent = nullptr;
-            string filename = "./data/" + nodeId + "_blockchain.json";
-            ofstream blockchainInitFile(filename);
-            if (blockchainInitFile.is_open())
-            {
-                blockchainInitFile << "[]"; // Initialize with an empty array
-                blockchainInitFile.close();
-            }
         }
         broadcastBlock(block, peer->nodeId);
         // Remove transactions in the block from the transaction queue
@@ -796,10 +583,7 @@ void Player::receiveBlock(const BlockGame &block, Player *peer)
                 bool found = false;
                 for (const auto &blockTxn : block.moves)
                 {
-                    if (txn.id == blockTxn.id &&
-                        txn.sender == blockTxn.sender &&
-                        txn.receiver == blockTxn.receiver &&
-                        txn.data == blockTxn.data)
+                    if (txn.digest() == blockTxn.digest())
                     {
                         found = true;
                         break;
@@ -815,77 +599,8 @@ void Player::receiveBlock(const BlockGame &block, Player *peer)
         }
 
         // Remove transactions in the block from the mempool
-        string mempoolFilename = "./data/" + nodeId + "_mempool.json";
-        json mempool = json::array();
-
-        ifstream mempoolInFile(mempoolFilename);
-        if (mempoolInFile.is_open())
-        {
-            try
-            {
-                mempoolInFile >> mempool;
-            }
-            catch (const json::parse_error &e)
-            {
-                cerr << "Error parsing JSON 4: " << e.what() << endl;
-            }
-            mempoolInFile.close();
-        }
-
-        for (const auto &txn : block.moves)
-        {
-            auto it = remove_if(mempool.begin(), mempool.end(),
-                                [&txn](const json &mempoolTxn)
-                                {
-                                    return mempoolTxn["id"] == txn.id &&
-                                           mempoolTxn["sender"] == txn.sender &&
-                                           mempoolTxn["receiver"] == txn.receiver &&
-                                           mempoolTxn["data"] == txn.data;
-                                });
-            mempool.erase(it, mempool.end());
-        }
-
-        ofstream mempoolOutFile(mempoolFilename, ios::trunc);
-        if (mempoolOutFile.is_open())
-        {
-            mempoolOutFile << mempool.dump(4); // Pretty print with 4 spaces
-            mempoolOutFile.close();
-        }
-        string filename = "./data/" + nodeId + "_blockchain.json";
-        json blockchainJson;
-
-        ifstream inFile(filename);
-        if (inFile.is_open())
-        {
-            inFile >> blockchainJson;
-            inFile.close();
-        }
-
-        json blockJson = {
-            {"index", block.index},
-            {"previousHash", block.previousHash},
-            {"hash", block.hash},
-            {"timestamp", block.timestamp},
-            {"moves", json::array()},
-            {"nonce", block.nonce},
-            {"gameId", blockchain.gameId}};
-
-        for (const auto &txn : block.moves)
-        {
-            blockJson["moves"].push_back({{"id", txn.id},
-                                          {"sender", txn.sender},
-                                          {"receiver", txn.receiver},
-                                          {"data", txn.data}});
-        }
-
-        blockchainJson.push_back(blockJson);
-
-        ofstream outFile(filename);
-        if (outFile.is_open())
-        {
-            outFile << blockchainJson.dump(4); // Pretty print with 4 spaces
-            outFile.close();
-        }
+        updateMempoolFile(block.moves);
+        saveBlockchainFile();
     }
 }
 
@@ -901,8 +616,15 @@ bool Player::verifyNewBlock(const BlockGame &block)
             return false;
     }
 
-    string target(block.difficulty, '0');
-    if (block.hash.substr(0, block.difficulty) != target)
+    // Check against the difficulty the game chain requires at this height, not the one the block declares
+    size_t height = blockchain.getChain().size();
+    if (block.index != (int)height)
+        return false;
+    // The header hashes the stored root, so the moves must be checked against it first
+    if (!block.merkleRootMatches())
+        return false;
+    if (block.calculateHash(block.nonce) != block.hash ||
+        !Miner::meetsTarget(block.hash, blockchain.requiredDifficulty(height)))
         return false;
 
     return true;
@@ -916,70 +638,23 @@ void Player::addMove(const Move &txn)
         queue<Move> tempQueue = transactionQueue;
         while (!tempQueue.empty())
         {
-            const auto &queuedTxn = tempQueue.front();
-            tempQueue.pop();
-
-            if (queuedTxn.id == txn.id &&
-                queuedTxn.sender == txn.sender &&
-                queuedTxn.receiver == txn.receiver &&
-                queuedTxn.data == txn.data)
+            if (tempQueue.front().digest() == txn.digest())
             {
                 std::cout << "Transaction already exists in the transactionQueue" << endl;
                 return;
             }
+            tempQueue.pop();
         }
 
         {
             lock_guard<mutex> lock(mtx);
             std::cout << "here" << endl;
-            std::cout << txn.data << endl;
+            std::cout << txn.chessMove.toUci() << endl;
+            mempool->add(txn.digest(), ChainCodec::encodeMove(txn)); // Journaled before a miner can take it
             transactionQueue.push(txn);
         }
         cv.notify_all();
 
-        string filename = "./data/" + nodeId + "_mempool.json";
-        ifstream checkFile(filename);
-        if (checkFile.peek() == ifstream::traits_type::eof())
-        {
-            ofstream initFile(filename);
-            if (initFile.is_open())
-            {
-                initFile << "[]";
-                initFile.close();
-            }
-        }
-        json mempool = json::array();
-
-        ifstream inFile(filename);
-        if (inFile.is_open())
-        {
-            try
-            {
-                inFile >> mempool;
-            }
-            catch (const json::parse_error &e)
-            {
-                cerr << "Error parsing JSON 5: " << e.what() << endl;
-            }
-            inFile.close();
-        }
-
-        json txnJson = {
-            {"id", txn.id},
-            {"sender", txn.sender},
-            {"receiver", txn.receiver},
-            {"data", txn.data}};
-
-        mempool.push_back(txnJson);
-
-        std::cout << mempool.size() << endl;
-        ofstream outFile(filename, ios::trunc);
-        if (outFile.is_open())
-        {
-            outFile << mempool.dump(4);
-            outFile.close();
-        }
-
         // logMessage("Transaction added to Node " + nodeId + ": " + txn.toString());
         broadcastTransaction(txn);
     }
@@ -996,77 +671,79 @@ void Player::addTransaction(const Move &txn, Player *peer)
         queue<Move> tempQueue = transactionQueue;
         while (!tempQueue.empty())
         {
-            const auto &queuedTxn = tempQueue.front();
-            tempQueue.pop();
-
-            if (queuedTxn.id == txn.id &&
-                queuedTxn.sender == txn.sender &&
-                queuedTxn.receiver == txn.receiver &&
-                queuedTxn.data == txn.data)
+            if (tempQueue.front().digest() == txn.digest())
             {
                 std::cout << "Transaction already exists in the transactionQueue" << endl;
                 return;
             }
+            tempQueue.pop();
         }
         {
             lock_guard<mutex> lock(mtx);
-            std::cout << txn.data << endl;
+            std::cout << txn.chessMove.toUci() << endl;
+            mempool->add(txn.digest(), ChainCodec::encodeMove(txn)); // Journaled before a miner can take it
             transactionQueue.push(txn);
         }
         cv.notify_all();
         broadcastTransaction(txn, peer);
         std::cout << "Node2 created successfully!" << endl;
 
-        string filename = "./data/" + nodeId + "_mempool.json";
-        ifstream checkFile(filename);
-        if (checkFile.peek() == ifstream::traits_type::eof())
-        {
-            ofstream initFile(filename);
-            if (initFile.is_open())
-            {
-                initFile << "[]";
-                initFile.close();
-            }
-        }
-        json mempool = json::array();
+        // logMessage("Transaction added to Node " + nodeId + ": " + txn.toString());
+        std::cout << "Node2 created successfully!" << endl;
+    }
+    else
+    {
+        std::cout << "P2: Invalid transaction" << endl;
+    }
+}
+
+void Player::updateMempoolFile(const vector<Move> &moves)
+{
+    vector<Hash256> digests;
+    digests.reserve(moves.size());
+    for (const auto &txn : moves)
+    {
+        digests.push_back(txn.digest());
+    }
+    mempool->remove(digests);
+}
+
+void Player::cancelMining()
+{
+    lock_guard<mutex> lock(mtxJob);
+    if (currentJob)
+    {
+        currentJob->cancel();
+    }
+}
 
-        ifstream inFile(filename);
-        if (inFile.is_open())
+void Player::requeueDisplaced(const vector<Move> &moves, size_t fromHeight)
+{
+    // Moves a competing block already included are dropped, the rest go back into the mempool
+    vector<BlockGame> chain = blockchain.getChain();
+    {
+        lock_guard<mutex> lock(mtx);
+        for (const auto &txn : moves)
         {
-            try
+            bool included = false;
+            for (size_t i = fromHeight; i < chain.size() && !included; i++)
             {
-                inFile >> mempool;
+                for (const auto &blockTxn : chain[i].moves)
+                {
+                    if (txn.digest() == blockTxn.digest())
+                    {
+                        included = true;
+                        break;
+                    }
+                }
             }
-            catch (const json::parse_error &e)
+            if (!included)
             {
-                cerr << "Error parsing JSON 6: " << e.what() << endl;
+                transactionQueue.push(txn);
             }
-            inFile.close();
-        }
-
-        json txnJson = {
-            {"id", txn.id},
-            {"sender", txn.sender},
-            {"receiver", txn.receiver},
-            {"data", txn.data}};
-
-        mempool.push_back(txnJson);
-
-        std::cout << mempool.size() << endl;
-        ofstream outFile(filename, ios::trunc);
-        if (outFile.is_open())
-        {
-            outFile << mempool.dump(4);
-            outFile.close();
         }
-
-        // logMessage("Transaction added to Node " + nodeId + ": " + txn.toString());
-        std::cout << "Node2 created successfully!" << endl;
-    }
-    else
-    {
-        std::cout << "P2: Invalid transaction" << endl;
     }
+    cv.notify_all();
 }
 
 void Player::stop()
@@ -1076,6 +753,12 @@ void Player::stop()
         running = false;
     }
     cv.notify_all();
+    cancelMining();
+}
+
+uint64_t Player::getWastedHashes() const
+{
+    return wastedHashes;
 }
 
 Player::~Player()
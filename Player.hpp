@@ -2,6 +2,8 @@
 #define PLAYER_HPP
 
 #include <iostream>
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <thread>
 #include <mutex>
@@ -10,14 +12,18 @@
 #include <string>
 #include <nlohmann/json.hpp>
 #include "Game.hpp"
+#include "Logger.hpp"
 #include "Move.hpp"
 #include "MainNode.hpp"
+#include "Keystore.hpp"
+#include "MempoolJournal.hpp"
+#include "MoveJournal.hpp"
+#include "Checkpoint.hpp"
 
 class Player
 {
 private:
     Game &blockchain;
-    int difficulty;
     queue<Move> transactionQueue;
     mutex mtx;
     mutex mtxPeers;
@@ -25,7 +31,12 @@ private:
     vector<Player *> peers;
     vector<MainNode *> mainNodes;
     queue<Game> completeGames;
-    void logMessage(const string &message);
+    mutex mtxJob;
+    shared_ptr<MiningJob> currentJob; // Block being mined, cancelled when a peer's block is accepted
+    atomic<uint64_t> wastedHashes{0}; // Hashes spent on blocks that went stale
+    unique_ptr<MempoolJournal> mempool; // ./data/<nodeId>_mempool.snapshot and .journal
+    unique_ptr<MoveJournal> createdMoves; // ./data/<nodeId>_moves.journal
+    LogLevel logLevel = LogLevel::Info; // Resolved from Logger once the node id is known
     bool isValidMove(const Move &txn);
     void broadcastTransaction(const Move &txn);
     void broadcastTransaction(const Move &txn, Player *peer);
@@ -35,26 +46,47 @@ private:
     void receiveBlock(const BlockGame &block, Player *peer);
     bool verifyNewBlock(const BlockGame &block);
     void syncPeers();
-    bool verifyValidGame(const Game &game);
+    // Blocks below fromHeight are only checked for linkage
+    bool verifyValidGame(const Game &game, size_t fromHeight = 1);
     void generateKeyPair();
+    void useKey(const KeyHandle &key);
+    void initialize();
+    void cancelMining();
+    // Requeues the moves no block from fromHeight up to the tip already carries
+    void requeueDisplaced(const vector<Move> &moves, size_t fromHeight);
+    // Journals the removal of moves that left the mempool
+    void updateMempoolFile(const vector<Move> &moves);
+    // Durably rewrite {nodeId}_game.dat / {nodeId}_completeGames.dat from memory
+    void saveBlockchainFile();
+    void saveCompleteGamesFile();
 
 public:
-    Player(int diff = 4);
+    Player();
+    // Restores an identity from the keystore instead of generating a new key
+    explicit Player(const KeyRecord &record);
     bool running = true;
     Player *opponent;
-    string nodeId;
+    string nodeId;   // Hex of address
+    Address address; // Fingerprint of publicKey, registered with KeyCache
     string publicKey;
     string privateKey;
+    KeyHandle signingKey; // Parsed once from privateKey and used for every move
 
     void addMove(const Move &txn);
     void addCompleteGame(const Game &game);
     void sendCompleteGame();
     void mineBlock();
     bool gameStrated(Player &opponent, Game &newChain);
+    // Reads back an in-progress game from ./data/{nodeId}_game.dat, validating blocks past the checkpoint
+    bool loadSavedGame(Game &game);
+    CheckpointEntry checkpoint();
     void connectPeer(Player &peer);
     void connectNode(MainNode &peer);
-    void createMove(string data);
+    // Takes the move in UCI notation, e.g. "e2e4" or "e7e8q"
+    void createMove(const string &uci);
     void stop();
+    uint64_t getWastedHashes() const;
+    KeyRecord keyRecord() const;
     ~Player();
 };
 
@@ -0,0 +1,63 @@
+#include "RatingSnapshot.hpp"
+#include "Bytes.hpp"
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+static const string MAGIC = "CCRS";
+
+bool RatingSnapshot::empty() const
+{
+    return height == 0;
+}
+
+string RatingSnapshot::encode() const
+{
+    string out = MAGIC;
+    out.reserve(MAGIC.size() + 48 + ratings.size() * 40);
+    appendUint32(out, VERSION);
+    appendUint64(out, height);
+    appendHash(out, tip);
+    appendUint32(out, (uint32_t)ratings.size());
+    for (const auto &entry : ratings)
+    {
+        uint64_t bits;
+        memcpy(&bits, &entry.second, sizeof(bits));
+        appendHash(out, entry.first);
+        appendUint64(out, bits);
+    }
+    return out;
+}
+
+RatingSnapshot RatingSnapshot::decode(const string &bytes)
+{
+    ByteReader reader(bytes);
+    if (reader.readBytes(MAGIC.size()) != MAGIC)
+    {
+        throw runtime_error("Not a rating snapshot");
+    }
+    uint32_t version = reader.readUint32();
+    if (version != VERSION)
+    {
+        throw runtime_error("Unsupported rating snapshot version " + to_string(version));
+    }
+
+    RatingSnapshot snapshot;
+    snapshot.height = reader.readUint64();
+    snapshot.tip = readHash(reader);
+    uint32_t count = reader.readUint32();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Address address = readHash(reader);
+        uint64_t bits = reader.readUint64();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        snapshot.ratings.emplace_back(address, value);
+    }
+    if (!reader.done())
+    {
+        throw runtime_error("Trailing bytes in rating snapshot");
+    }
+    return snapshot;
+}
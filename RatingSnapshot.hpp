@@ -0,0 +1,29 @@
+#ifndef RATINGSNAPSHOT_HPP
+#define RATINGSNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Hash256.hpp"
+#include "KeyCache.hpp"
+
+// Every player's rating after the first `height` blocks of a main chain, tied to the hash of
+// block height - 1 so it is only ever applied to the chain it came from. Encoded as a
+// magic/version header, height, tip, then one 40 byte (address, rating) entry per player
+// sorted by address, so equal states encode to equal bytes.
+struct RatingSnapshot
+{
+    static const uint32_t VERSION = 1;
+
+    uint64_t height = 0; // 0 means no snapshot
+    Hash256 tip;
+    std::vector<std::pair<Address, double>> ratings;
+
+    bool empty() const;
+    std::string encode() const;
+    // Throws runtime_error on malformed input or an unknown version
+    static RatingSnapshot decode(const std::string &bytes);
+};
+
+#endif
@@ -0,0 +1,325 @@
+#include "RecordView.hpp"
+#include "Bytes.hpp"
+#include "Merkle.hpp"
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+// Fixed offsets inside a move body (see Move::canonicalBytes)
+static const size_t MOVE_SCHEME = 4;
+static const size_t MOVE_SENDER = 5;
+static const size_t MOVE_RECEIVER = 37;
+static const size_t MOVE_CHESS = 69;
+static const size_t MOVE_SIGNATURE = 71;
+
+static Hash256 hashAt(string_view body, size_t offset)
+{
+    Hash256 hash;
+    memcpy(hash.data(), body.data() + offset, hash.size());
+    return hash;
+}
+
+static vector<string_view> readBodies(ByteReader &reader)
+{
+    uint32_t count = reader.readCount(4); // Each body carries at least its length
+    vector<string_view> bodies;
+    bodies.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bodies.push_back(reader.readStringView());
+    }
+    return bodies;
+}
+
+static void expectDone(const ByteReader &reader, const string &what)
+{
+    if (!reader.done())
+    {
+        throw runtime_error("Trailing bytes after " + what);
+    }
+}
+
+MoveView::MoveView(string_view body) : body(body)
+{
+    ByteReader reader(body);
+    reader.skip(MOVE_SIGNATURE);
+    reader.readStringView();
+    expectDone(reader, "move");
+    if (!SignatureScheme::isKnown(scheme()))
+    {
+        throw runtime_error("Unknown signature scheme " + to_string((int)scheme()));
+    }
+}
+
+uint32_t MoveView::id() const
+{
+    ByteReader reader(body);
+    return reader.readUint32();
+}
+
+SignatureAlgorithm MoveView::scheme() const
+{
+    return (SignatureAlgorithm)(uint8_t)body[MOVE_SCHEME];
+}
+
+Address MoveView::sender() const
+{
+    return hashAt(body, MOVE_SENDER);
+}
+
+Address MoveView::receiver() const
+{
+    return hashAt(body, MOVE_RECEIVER);
+}
+
+ChessMove MoveView::chessMove() const
+{
+    return ChessMove::fromPacked((uint16_t)((uint8_t)body[MOVE_CHESS] << 8 | (uint8_t)body[MOVE_CHESS + 1]));
+}
+
+string_view MoveView::signature() const
+{
+    return body.substr(MOVE_SIGNATURE + 4);
+}
+
+Sha256::Digest MoveView::digest() const
+{
+    return Sha256::hash(body.data(), body.size());
+}
+
+GameBlockView::GameBlockView(string_view body)
+{
+    ByteReader reader(body);
+    index = (int)reader.readUint32();
+    previousHash = readHash(reader);
+    timestamp = (long)reader.readUint64();
+    nonce = (int)reader.readUint32();
+    difficulty = (int)reader.readUint32();
+    hash = readHash(reader);
+    moveBodies = readBodies(reader);
+    expectDone(reader, "game block " + to_string(index));
+}
+
+MoveView GameBlockView::move(size_t i) const
+{
+    return MoveView(moveBodies.at(i));
+}
+
+Sha256::Digest GameBlockView::merkleRoot() const
+{
+    vector<Sha256::Digest> leaves;
+    leaves.reserve(moveBodies.size());
+    for (size_t i = 0; i < moveBodies.size(); i++)
+    {
+        leaves.push_back(Merkle::leafHash(move(i).digest()));
+    }
+    return Merkle::root(leaves);
+}
+
+BlockHeader GameBlockView::header() const
+{
+    BlockHeader header;
+    header.index = index;
+    header.previousHash = previousHash;
+    header.timestamp = timestamp;
+    header.merkleRoot = merkleRoot();
+    header.nonce = nonce;
+    return header;
+}
+
+bool GameBlockView::verify() const
+{
+    try
+    {
+        return header().hash() == hash;
+    }
+    catch (const exception &)
+    {
+        return false; // A move body that is not a move
+    }
+}
+
+GameView::GameView(string_view body)
+{
+    ByteReader reader(body);
+    gameId = (int)reader.readUint32();
+    uint32_t playerCount = reader.readCount(Address().size());
+    players.reserve(playerCount);
+    for (uint32_t i = 0; i < playerCount; i++)
+    {
+        players.push_back(readHash(reader));
+    }
+    winnerId = readHash(reader);
+    gameComplete = reader.readUint8() != 0;
+    blockBodies = readBodies(reader);
+    expectDone(reader, "game " + to_string(gameId));
+}
+
+GameBlockView GameView::block(size_t i) const
+{
+    return GameBlockView(blockBodies.at(i));
+}
+
+Sha256::Digest GameView::digest() const
+{
+    // Mirrors Game::canonicalBytes(): block headers and hashes only, no moves
+    string out;
+    appendUint32(out, (uint32_t)gameId);
+    appendUint32(out, (uint32_t)players.size());
+    for (const auto &player : players)
+    {
+        out.append(reinterpret_cast<const char *>(player.data()), player.size());
+    }
+    out.append(reinterpret_cast<const char *>(winnerId.data()), winnerId.size());
+    appendUint8(out, gameComplete ? 1 : 0);
+    appendUint32(out, (uint32_t)blockBodies.size());
+    for (auto body : blockBodies)
+    {
+        // Index and hash sit at fixed offsets in a game block body
+        if (body.size() < 84)
+        {
+            throw runtime_error("Truncated record");
+        }
+        out.append(body.data(), 4);
+        out.append(body.data() + 52, 32);
+    }
+    return Sha256::hash(out);
+}
+
+bool GameView::verify() const
+{
+    try
+    {
+        Hash256 previous{};
+        for (size_t i = 0; i < blockBodies.size(); i++)
+        {
+            GameBlockView view = block(i);
+            if (!view.verify() || (i > 0 && view.previousHash != previous))
+            {
+                return false;
+            }
+            previous = view.hash;
+        }
+        return true;
+    }
+    catch (const exception &)
+    {
+        return false;
+    }
+}
+
+MainBlockView::MainBlockView(string_view body)
+{
+    ByteReader reader(body);
+    index = (int)reader.readUint32();
+    previousHash = readHash(reader);
+    timestamp = (long)reader.readUint64();
+    nonce = (int)reader.readUint32();
+    difficulty = (int)reader.readUint32();
+    hash = readHash(reader);
+    gameBodies = readBodies(reader);
+    expectDone(reader, "block " + to_string(index));
+}
+
+GameView MainBlockView::game(size_t i) const
+{
+    return GameView(gameBodies.at(i));
+}
+
+Sha256::Digest MainBlockView::merkleRoot() const
+{
+    vector<Sha256::Digest> leaves;
+    leaves.reserve(gameBodies.size());
+    for (size_t i = 0; i < gameBodies.size(); i++)
+    {
+        leaves.push_back(Merkle::leafHash(game(i).digest()));
+    }
+    return Merkle::root(leaves);
+}
+
+BlockHeader MainBlockView::header() const
+{
+    BlockHeader header;
+    header.index = index;
+    header.previousHash = previousHash;
+    header.timestamp = timestamp;
+    header.merkleRoot = merkleRoot();
+    header.nonce = nonce;
+    return header;
+}
+
+bool MainBlockView::verify() const
+{
+    try
+    {
+        if (header().hash() != hash)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < gameBodies.size(); i++)
+        {
+            GameView view = game(i);
+            for (size_t b = 0; b < view.blockCount(); b++)
+            {
+                if (!view.block(b).verify())
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    catch (const exception &)
+    {
+        return false;
+    }
+}
+
+RecordView::RecordView(string_view record)
+{
+    ByteReader reader(record);
+    recordType = (RecordType)reader.readUint8();
+    formatVersion = reader.readUint8();
+    if (recordType < RecordType::Move || recordType > RecordType::MainBlock)
+    {
+        throw runtime_error("Unknown record type " + to_string((int)recordType));
+    }
+    if (formatVersion != ChainCodec::FORMAT_VERSION)
+    {
+        throw runtime_error("Unsupported record format version " + to_string((int)formatVersion));
+    }
+    body = record.substr(ChainCodec::RECORD_HEADER_SIZE);
+}
+
+static void expectType(RecordType actual, RecordType expected)
+{
+    if (actual != expected)
+    {
+        throw runtime_error("Expected record type " + to_string((int)expected) + ", found " + to_string((int)actual));
+    }
+}
+
+MoveView RecordView::move() const
+{
+    expectType(recordType, RecordType::Move);
+    return MoveView(body);
+}
+
+GameBlockView RecordView::gameBlock() const
+{
+    expectType(recordType, RecordType::GameBlock);
+    return GameBlockView(body);
+}
+
+GameView RecordView::game() const
+{
+    expectType(recordType, RecordType::Game);
+    return GameView(body);
+}
+
+MainBlockView RecordView::mainBlock() const
+{
+    expectType(recordType, RecordType::MainBlock);
+    return MainBlockView(body);
+}
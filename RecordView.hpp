@@ -0,0 +1,128 @@
+#ifndef RECORDVIEW_HPP
+#define RECORDVIEW_HPP
+
+#include <string_view>
+#include <vector>
+#include "ChainCodec.hpp"
+#include "BlockHeader.hpp"
+#include "ChessMove.hpp"
+#include "SignatureScheme.hpp"
+
+// Zero-copy readers over ChainCodec records. A view checks the layout when it is built
+// and keeps string_views into the caller's bytes (a file buffer or a mapped log), which
+// must outlive it. Hashes, Merkle roots and digests are computed straight from those
+// bytes, so a record can be validated without building Move/Game/Block objects.
+// Signatures are never checked here; that needs the sender keys (see Player/MainNode).
+
+class MoveView
+{
+private:
+    std::string_view body;
+
+public:
+    // Throws runtime_error if the bytes are not a move body
+    explicit MoveView(std::string_view body);
+
+    uint32_t id() const;
+    SignatureAlgorithm scheme() const;
+    Address sender() const;
+    Address receiver() const;
+    ChessMove chessMove() const;
+    std::string_view signature() const;
+
+    std::string_view canonicalBytes() const { return body; }
+    // Same value as Move::digest()
+    Sha256::Digest digest() const;
+};
+
+class GameBlockView
+{
+private:
+    std::vector<std::string_view> moveBodies;
+
+public:
+    int index;
+    Hash256 previousHash;
+    long timestamp;
+    int nonce;
+    int difficulty;
+    Hash256 hash;
+
+    explicit GameBlockView(std::string_view body);
+
+    size_t moveCount() const { return moveBodies.size(); }
+    MoveView move(size_t i) const;
+    Sha256::Digest merkleRoot() const;
+    BlockHeader header() const;
+    // Recomputes the hash from the header and the move digests
+    bool verify() const;
+};
+
+class GameView
+{
+private:
+    std::vector<std::string_view> blockBodies;
+
+public:
+    int gameId;
+    std::vector<Address> players;
+    Address winnerId;
+    bool gameComplete;
+
+    explicit GameView(std::string_view body);
+
+    size_t blockCount() const { return blockBodies.size(); }
+    GameBlockView block(size_t i) const;
+    // Same value as Game::digest()
+    Sha256::Digest digest() const;
+    // Every block matches its hash and links to the one before it
+    bool verify() const;
+};
+
+class MainBlockView
+{
+private:
+    std::vector<std::string_view> gameBodies;
+
+public:
+    int index;
+    Hash256 previousHash;
+    long timestamp;
+    int nonce;
+    int difficulty;
+    Hash256 hash;
+
+    explicit MainBlockView(std::string_view body);
+
+    size_t gameCount() const { return gameBodies.size(); }
+    GameView game(size_t i) const;
+    Sha256::Digest merkleRoot() const;
+    BlockHeader header() const;
+    // The block and every game block in it match their hashes
+    bool verify() const;
+};
+
+// A whole record: type and version byte, then one of the bodies above
+class RecordView
+{
+private:
+    RecordType recordType;
+    uint8_t formatVersion;
+    std::string_view body;
+
+public:
+    // Throws runtime_error on a truncated header, unknown type or unsupported version
+    explicit RecordView(std::string_view record);
+
+    RecordType type() const { return recordType; }
+    uint8_t version() const { return formatVersion; }
+    std::string_view payload() const { return body; }
+
+    // Each throws runtime_error if the record holds a different type
+    MoveView move() const;
+    GameBlockView gameBlock() const;
+    GameView game() const;
+    MainBlockView mainBlock() const;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Hash256.hpp"
+
+// Streaming SHA-256 that exposes its compression state, so a constant message
+// prefix can be hashed once and resumed from (the "midstate") many times.
+class Sha256
+{
+public:
+    static const size_t DIGEST_SIZE = 32;
+    static const size_t BLOCK_SIZE = 64;
+
+    using Digest = Hash256;
+    using State = std::array<uint32_t, 8>;
+
+    static const uint32_t ROUND_CONSTANTS[64];
+
+    Sha256();
+
+    void update(const void *data, size_t len);
+    void update(const std::string &data);
+    Digest final();
+
+    // Compression state after an exact multiple of BLOCK_SIZE bytes
+    State midstate() const;
+
+    static void compress(State &state, const unsigned char *block);
+    static Digest digestFromState(const State &state);
+    static Digest hash(const void *data, size_t len);
+    static Digest hash(const std::string &data);
+
+private:
+    State state;
+    unsigned char buffer[BLOCK_SIZE];
+    size_t bufferLen;
+    uint64_t totalLen;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "SignatureCache.hpp"
+
+using namespace std;
+
+SignatureCache::SignatureCache(size_t capacity)
+{
+    capacityPerShard = capacity / SHARDS == 0 ? 1 : capacity / SHARDS;
+}
+
+SignatureCache &SignatureCache::instance()
+{
+    static SignatureCache cache;
+    return cache;
+}
+
+SignatureCache::Shard &SignatureCache::shardFor(const Hash256 &key)
+{
+    // The first byte picks the shard; std::hash<Hash256> then picks the bucket inside it
+    return shards[key[0] % SHARDS];
+}
+
+bool SignatureCache::contains(const Hash256 &key)
+{
+    Shard &shard = shardFor(key);
+    bool found;
+    {
+        lock_guard<mutex> lock(shard.mtx);
+        found = shard.entries.count(key) > 0;
+    }
+    (found ? hits : misses)++;
+    return found;
+}
+
+void SignatureCache::insert(const Hash256 &key)
+{
+    Shard &shard = shardFor(key);
+    lock_guard<mutex> lock(shard.mtx);
+    if (!shard.entries.insert(key).second)
+    {
+        return;
+    }
+    shard.order.push_back(key);
+    if (shard.order.size() > capacityPerShard)
+    {
+        shard.entries.erase(shard.order.front());
+        shard.order.pop_front();
+        evictions++;
+    }
+}
+
+void SignatureCache::clear()
+{
+    for (auto &shard : shards)
+    {
+        lock_guard<mutex> lock(shard.mtx);
+        shard.entries.clear();
+        shard.order.clear();
+    }
+}
+
+SignatureCacheStats SignatureCache::stats()
+{
+    SignatureCacheStats result;
+    result.hits = hits;
+    result.misses = misses;
+    result.evictions = evictions;
+    for (auto &shard : shards)
+    {
+        lock_guard<mutex> lock(shard.mtx);
+        result.entries += shard.entries.size();
+    }
+    return result;
+}
@@ -0,0 +1,58 @@
+#ifndef SIGNATURECACHE_HPP
+#define SIGNATURECACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include "Hash256.hpp"
+
+struct SignatureCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+};
+
+// Move::verificationDigest() values (scheme, signed message and signature) whose
+// signature has already been verified in this process. Only successful checks are
+// remembered. Entries are spread over independently locked shards, each evicting its
+// oldest entry once full.
+class SignatureCache
+{
+private:
+    static const size_t SHARDS = 16;
+
+    struct Shard
+    {
+        std::mutex mtx;
+        std::unordered_set<Hash256> entries;
+        std::deque<Hash256> order; // Insertion order, oldest first
+    };
+
+    std::array<Shard, SHARDS> shards;
+    size_t capacityPerShard;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+
+    Shard &shardFor(const Hash256 &key);
+
+public:
+    static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit SignatureCache(size_t capacity = DEFAULT_CAPACITY);
+
+    static SignatureCache &instance();
+
+    // Counts a hit or a miss
+    bool contains(const Hash256 &key);
+    void insert(const Hash256 &key);
+    void clear();
+    SignatureCacheStats stats();
+};
+
+#endif
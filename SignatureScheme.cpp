@@ -0,0 +1,225 @@
+#include "SignatureScheme.hpp"
+#include "Move.hpp"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+
+using namespace std;
+
+static atomic<SignatureAlgorithm> configuredAlgorithm{SignatureAlgorithm::RSA2048};
+
+class Rsa2048Scheme : public SignatureScheme
+{
+public:
+    SignatureAlgorithm algorithm() const override { return SignatureAlgorithm::RSA2048; }
+    const char *name() const override { return "rsa2048"; }
+    int keyType() const override { return EVP_PKEY_RSA; }
+
+    KeyHandle generateKey() const override
+    {
+        EVP_PKEY *key = nullptr;
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+        bool ok = ctx && EVP_PKEY_keygen_init(ctx) > 0 &&
+                  EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, 2048) > 0 &&
+                  EVP_PKEY_keygen(ctx, &key) > 0;
+        EVP_PKEY_CTX_free(ctx);
+        if (!ok)
+        {
+            throw runtime_error("RSA key generation failed.");
+        }
+        return KeyCache::wrap(key);
+    }
+
+protected:
+    const EVP_MD *messageDigest() const override { return EVP_sha256(); }
+};
+
+class Ed25519Scheme : public SignatureScheme
+{
+public:
+    SignatureAlgorithm algorithm() const override { return SignatureAlgorithm::ED25519; }
+    const char *name() const override { return "ed25519"; }
+    int keyType() const override { return EVP_PKEY_ED25519; }
+
+    KeyHandle generateKey() const override
+    {
+        EVP_PKEY *key = nullptr;
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr);
+        bool ok = ctx && EVP_PKEY_keygen_init(ctx) > 0 && EVP_PKEY_keygen(ctx, &key) > 0;
+        EVP_PKEY_CTX_free(ctx);
+        if (!ok)
+        {
+            throw runtime_error("Ed25519 key generation failed.");
+        }
+        return KeyCache::wrap(key);
+    }
+
+protected:
+    const EVP_MD *messageDigest() const override { return nullptr; }
+};
+
+string SignatureScheme::sign(EVP_PKEY *key, const string &message) const
+{
+    EVP_MD_CTX *ctx = KeyCache::threadContext();
+    if (EVP_PKEY_get_base_id(key) != keyType() ||
+        EVP_DigestSignInit(ctx, nullptr, messageDigest(), nullptr, key) <= 0)
+    {
+        return "";
+    }
+
+    // One-shot calls, since Ed25519 has no streaming interface
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(message.data());
+    size_t sigLen = 0;
+    if (EVP_DigestSign(ctx, nullptr, &sigLen, data, message.size()) <= 0)
+    {
+        return "";
+    }
+    string signature(sigLen, '\0');
+    if (EVP_DigestSign(ctx, reinterpret_cast<unsigned char *>(&signature[0]), &sigLen, data, message.size()) <= 0)
+    {
+        return "";
+    }
+    signature.resize(sigLen);
+    return signature;
+}
+
+bool SignatureScheme::verify(EVP_PKEY *key, const string &message, const string &signature) const
+{
+    EVP_MD_CTX *ctx = KeyCache::threadContext();
+    if (EVP_PKEY_get_base_id(key) != keyType() ||
+        EVP_DigestVerifyInit(ctx, nullptr, messageDigest(), nullptr, key) <= 0)
+    {
+        return false;
+    }
+    return EVP_DigestVerify(ctx, reinterpret_cast<const unsigned char *>(signature.data()), signature.size(),
+                            reinterpret_cast<const unsigned char *>(message.data()), message.size()) == 1;
+}
+
+const vector<const SignatureScheme *> &SignatureScheme::all()
+{
+    static const Rsa2048Scheme rsa;
+    static const Ed25519Scheme ed25519;
+    static const vector<const SignatureScheme *> schemes = {&rsa, &ed25519};
+    return schemes;
+}
+
+bool SignatureScheme::isKnown(SignatureAlgorithm algorithm)
+{
+    for (const auto *scheme : all())
+    {
+        if (scheme->algorithm() == algorithm)
+            return true;
+    }
+    return false;
+}
+
+const SignatureScheme &SignatureScheme::get(SignatureAlgorithm algorithm)
+{
+    for (const auto *scheme : all())
+    {
+        if (scheme->algorithm() == algorithm)
+            return *scheme;
+    }
+    throw runtime_error("Unknown signature algorithm " + to_string((int)algorithm));
+}
+
+SignatureAlgorithm SignatureScheme::algorithmOf(EVP_PKEY *key)
+{
+    return EVP_PKEY_get_base_id(key) == EVP_PKEY_ED25519 ? SignatureAlgorithm::ED25519 : SignatureAlgorithm::RSA2048;
+}
+
+SignatureAlgorithm SignatureScheme::parse(const string &name)
+{
+    if (name == "rsa" || name == "rsa2048")
+        return SignatureAlgorithm::RSA2048;
+    if (name == "ed25519")
+        return SignatureAlgorithm::ED25519;
+    throw runtime_error("Unknown signature scheme: " + name);
+}
+
+void SignatureScheme::setDefault(SignatureAlgorithm algorithm)
+{
+    configuredAlgorithm = algorithm;
+}
+
+SignatureAlgorithm SignatureScheme::defaultAlgorithm()
+{
+    return configuredAlgorithm;
+}
+
+static string readBio(BIO *bio)
+{
+    char *data;
+    long len = BIO_get_mem_data(bio, &data);
+    string out(data, len);
+    BIO_free(bio);
+    return out;
+}
+
+string SignatureScheme::publicKeyPem(EVP_PKEY *key)
+{
+    BIO *bio = BIO_new(BIO_s_mem());
+    if (!PEM_write_bio_PUBKEY(bio, key))
+    {
+        BIO_free(bio);
+        throw runtime_error("Failed to write public key.");
+    }
+    return readBio(bio);
+}
+
+string SignatureScheme::privateKeyPem(EVP_PKEY *key)
+{
+    BIO *bio = BIO_new(BIO_s_mem());
+    if (!PEM_write_bio_PrivateKey(bio, key, nullptr, nullptr, 0, nullptr, nullptr))
+    {
+        BIO_free(bio);
+        throw runtime_error("Failed to write private key.");
+    }
+    return readBio(bio);
+}
+
+void SignatureScheme::benchmark(ostream &out, double secondsPerScheme)
+{
+    out << "Signature scheme benchmark (single thread, " << secondsPerScheme << "s per operation)" << endl;
+    for (const auto *scheme : all())
+    {
+        KeyHandle sender = scheme->generateKey();
+        KeyHandle receiver = scheme->generateKey();
+        Address senderAddress = KeyCache::instance().registerKey(publicKeyPem(sender.get()));
+        Address receiverAddress = KeyCache::instance().registerKey(publicKeyPem(receiver.get()));
+        Move move(senderAddress, receiverAddress, ChessMove::fromUci("g1f3"));
+        move.signTransaction(sender.get());
+
+        uint64_t signs = 0;
+        auto start = chrono::steady_clock::now();
+        double signSeconds = 0.0;
+        while (signSeconds < secondsPerScheme)
+        {
+            move.signTransaction(sender.get());
+            signs++;
+            signSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+        uint64_t verifies = 0;
+        bool ok = true;
+        start = chrono::steady_clock::now();
+        double verifySeconds = 0.0;
+        while (verifySeconds < secondsPerScheme)
+        {
+            ok = move.verifySignature() && ok;
+            verifies++;
+            verifySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+        out << "  " << left << setw(8) << scheme->name() << fixed << setprecision(0)
+            << " sign=" << setw(7) << signs / signSeconds << "/s"
+            << " verify=" << setw(7) << verifies / verifySeconds << "/s"
+            << " signature=" << move.signature.size() << "B"
+            << " publicKey=" << KeyCache::instance().publicKeyPem(senderAddress).size() << "B"
+            << " move=" << move.canonicalBytes().size() << "B"
+            << (ok ? "" : " VERIFY FAILED") << endl;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SIGNATURESCHEME_HPP
+#define SIGNATURESCHEME_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include "KeyCache.hpp"
+
+// Recorded on every signed move; the values are part of the move's canonical encoding
+enum class SignatureAlgorithm : uint8_t
+{
+    RSA2048 = 1,
+    ED25519 = 2,
+};
+
+// One way of generating keys and signing move messages with them
+class SignatureScheme
+{
+public:
+    virtual ~SignatureScheme() = default;
+
+    virtual SignatureAlgorithm algorithm() const = 0;
+    virtual const char *name() const = 0;
+    // OpenSSL key type (EVP_PKEY_RSA, EVP_PKEY_ED25519) this scheme signs with
+    virtual int keyType() const = 0;
+    virtual KeyHandle generateKey() const = 0;
+
+    // Empty string on failure
+    std::string sign(EVP_PKEY *key, const std::string &message) const;
+    // Also rejects keys of another scheme, so a signature can't be reinterpreted
+    bool verify(EVP_PKEY *key, const std::string &message, const std::string &signature) const;
+
+    static const SignatureScheme &get(SignatureAlgorithm algorithm);
+    // False for a value no scheme claims, e.g. a scheme byte read from a corrupt record
+    static bool isKnown(SignatureAlgorithm algorithm);
+    static const std::vector<const SignatureScheme *> &all();
+    // Scheme a key belongs to; RSA2048 for anything that isn't Ed25519
+    static SignatureAlgorithm algorithmOf(EVP_PKEY *key);
+    // Accepts "rsa" or "ed25519"; throws for anything else
+    static SignatureAlgorithm parse(const std::string &name);
+
+    // Scheme new players generate keys with
+    static void setDefault(SignatureAlgorithm algorithm);
+    static SignatureAlgorithm defaultAlgorithm();
+
+    static std::string publicKeyPem(EVP_PKEY *key);
+    static std::string privateKeyPem(EVP_PKEY *key);
+
+    // Sign/verify throughput and bytes per move for each scheme
+    static void benchmark(std::ostream &out, double secondsPerScheme = 1.0);
+
+protected:
+    // Digest passed to EVP_DigestSignInit; null for schemes that hash internally
+    virtual const EVP_MD *messageDigest() const = 0;
+};
+
+#endif
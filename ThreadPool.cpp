@@ -0,0 +1,72 @@
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    if (threads == 0)
+    {
+        threads = thread::hardware_concurrency();
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [this]
+                    { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                return; // Only exit once the queue is drained
+            }
+            task = move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        tasks.push(move(task));
+    }
+    cv.notify_one();
+}
+
+unsigned int ThreadPool::size() const
+{
+    return (unsigned int)workers.size();
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
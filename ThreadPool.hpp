@@ -0,0 +1,38 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO of tasks
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    // threads == 0 uses the hardware concurrency
+    explicit ThreadPool(unsigned int threads = 0);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task);
+    unsigned int size() const;
+
+    // Process-wide pool used for signature verification
+    static ThreadPool &shared();
+
+    ~ThreadPool();
+};
+
+#endif
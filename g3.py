@@ -6,15 +6,22 @@ import numpy as np
 from datetime import datetime
 from collections import defaultdict
 
-# Load the log data
-def load_log_data(file_path="logs.json"):
+# Load the log data (JSON Lines, one entry per line)
+def load_log_data(file_path="logs.jsonl"):
+    logs = []
     with open(file_path, 'r') as f:
-        logs = json.load(f)
+        for line in f:
+            line = line.strip()
+            if line:
+                logs.append(json.loads(line))
     return logs
 
+# Player node IDs are 64 hex digit key fingerprints; main node IDs are integers
+PLAYER_NODE_PATTERN = r'Node [0-9a-f]{64}'
+
 # Function to determine if a node is a player or main node
 def is_player_node(node_id):
-    return "-----END PUBLIC KEY-----" in node_id
+    return len(node_id) == 64 and all(c in '0123456789abcdef' for c in node_id)
 
 # Convert logs to DataFrame
 def logs_to_dataframe(logs):
@@ -103,8 +110,8 @@ def identify_peak_periods(df):
     timeline_df.set_index('timestamp', inplace=True)
     
     # Count different types of events for both player and main nodes
-    main_events = timeline_df[~timeline_df['message'].str.contains('-----END PUBLIC KEY-----', na=False)]
-    player_events = timeline_df[timeline_df['message'].str.contains('-----END PUBLIC KEY-----', na=False)]
+    main_events = timeline_df[~timeline_df['message'].str.contains(PLAYER_NODE_PATTERN, na=False)]
+    player_events = timeline_df[timeline_df['message'].str.contains(PLAYER_NODE_PATTERN, na=False)]
     
     # Resample into time bins
     main_event_counts = main_events.resample('1S').size()
@@ -137,8 +144,8 @@ def analyze_resource_utilization(df, main_nodes, player_nodes):
     timeline_df.set_index('timestamp', inplace=True)
     
     # Separate player and main node activity
-    main_mining = timeline_df[~timeline_df['message'].str.contains('-----END PUBLIC KEY-----', na=False)]
-    player_mining = timeline_df[timeline_df['message'].str.contains('-----END PUBLIC KEY-----', na=False)]
+    main_mining = timeline_df[~timeline_df['message'].str.contains(PLAYER_NODE_PATTERN, na=False)]
+    player_mining = timeline_df[timeline_df['message'].str.contains(PLAYER_NODE_PATTERN, na=False)]
     
     # Resample to count events per second
     main_activity_counts = main_mining.resample('1S').size()
@@ -3,6 +3,8 @@
 #include <string>
 #include <thread>
 #include <vector>
+#include <memory>
+#include <algorithm>
 #include <random>
 
 // #include "Wallet.cpp"
@@ -13,22 +15,36 @@
 #include "Game.hpp"
 #include "MainNode.hpp"
 #include "MainChain.hpp"
+#include "MiningKernel.hpp"
+#include "SignatureScheme.hpp"
+#include "KeyPool.hpp"
+#include "Keystore.hpp"
+#include "ChainExport.hpp"
+#include "Logger.hpp"
+#include "DurableWriter.hpp"
+#include "Checkpoint.hpp"
+#include "SignatureCache.hpp"
+#include "BatchVerifier.hpp"
 
 using namespace std;
 
-void initializeFiles()
+static const size_t PLAYER_COUNT = 8;
+
+void initializeFiles(bool recover)
 {
     cout << "creating files" << endl;
     std::ofstream transactionFile("./createdTransaction.json");
     transactionFile << "[]";
     transactionFile.close();
 
-    std::ofstream walletFile("./createdWallet.json");
-    walletFile << "[]";
-    walletFile.close();
+    if (recover)
+    {
+        // Keep ./data and the log; the nodes rebuild their state from them
+        system("mkdir -p ./data");
+        return;
+    }
 
-    std::ofstream logFile("./logs.json");
-    logFile << "[]";
+    std::ofstream logFile("./logs.jsonl", ios::trunc);
     logFile.close();
 
     // Delete the ./data folder if it exists
@@ -38,27 +54,81 @@ void initializeFiles()
     system("mkdir ./data");
 }
 
-string generateRandomMove()
+// Resumes every game both of its players still had in progress, from the longer of their two copies
+size_t resumeGames(vector<unique_ptr<Player>> &players)
+{
+    vector<unique_ptr<Game>> saved(players.size());
+    for (size_t i = 0; i < players.size(); i++)
+    {
+        Game game;
+        if (players[i]->loadSavedGame(game))
+        {
+            saved[i] = make_unique<Game>(game);
+        }
+    }
+
+    size_t resumed = 0;
+    for (size_t i = 0; i < players.size(); i++)
+    {
+        for (size_t j = i + 1; j < players.size() && saved[i]; j++)
+        {
+            if (!saved[j] || saved[j]->gameId != saved[i]->gameId ||
+                find(saved[i]->players.begin(), saved[i]->players.end(), players[j]->address) == saved[i]->players.end())
+            {
+                continue;
+            }
+            Game game = saved[i]->getChain().size() >= saved[j]->getChain().size() ? *saved[i] : *saved[j];
+            players[i]->gameStrated(*players[j], game);
+            players[j]->gameStrated(*players[i], game);
+            saved[j].reset();
+            resumed++;
+            break;
+        }
+    }
+    return resumed;
+}
+
+void writeCheckpoint(const vector<MainNode *> &nodes, const vector<unique_ptr<Player>> &players)
 {
-    const vector<string> files = {"a", "b", "c", "d", "e", "f", "g", "h"};
-    const vector<string> ranks = {"1", "2", "3", "4", "5", "6", "7", "8"};
-    const vector<string> pieces = {"", "N", "B", "R", "Q", "K"}; // Optional piece notation
+    Checkpoint checkpoint;
+    for (auto node : nodes)
+    {
+        checkpoint.add(node->checkpoint());
+    }
+    for (const auto &player : players)
+    {
+        checkpoint.add(player->checkpoint());
+    }
+    try
+    {
+        checkpoint.save();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: failed to write checkpoint: " << e.what() << endl;
+    }
+}
 
+string generateRandomMove()
+{
     random_device rd;
     mt19937 gen(rd());
-    uniform_int_distribution<> fileDist(0, files.size() - 1);
-    uniform_int_distribution<> rankDist(0, ranks.size() - 1);
-    uniform_int_distribution<> pieceDist(0, pieces.size() - 1);
+    uniform_int_distribution<> squareDist(0, 63);
 
-    string move = pieces[pieceDist(gen)] + files[fileDist(gen)] + ranks[rankDist(gen)];
-    return move;
+    int from = squareDist(gen);
+    int to = squareDist(gen);
+    while (to == from)
+    {
+        to = squareDist(gen);
+    }
+    return ChessMove(from, to).toUci();
 }
 
 bool createNewGame(Player &p1, Player &p2)
 {
     if (p1.opponent == nullptr && p2.opponent == nullptr)
     {
-        Game *newGame = new Game(vector<string>{p1.nodeId, p2.nodeId});
+        Game *newGame = new Game(vector<Address>{p1.address, p2.address});
         bool success1 = p1.gameStrated(ref(p2), *newGame);
         bool success2 = p2.gameStrated(ref(p1), *newGame);
 
@@ -75,18 +145,182 @@ bool createNewGame(Player &p1, Player &p2)
     return false;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && string(argv[1]) == "--bench-mining")
+    {
+        MiningKernel::benchmark(cout);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-signatures")
+    {
+        SignatureScheme::benchmark(cout);
+        return 0;
+    }
+    if (argc > 2 && string(argv[1]) == "--export-chain")
+    {
+        return ChainExport::exportChain(argv[2], argc > 3 ? argv[3] : "");
+    }
+    if (argc > 2 && string(argv[1]) == "--export-mempool")
+    {
+        return ChainExport::exportMempool(argv[2], argc > 3 ? argv[3] : "");
+    }
+    if (argc > 2 && string(argv[1]) == "--export-games")
+    {
+        return ChainExport::exportGames(argv[2], argc > 3 ? argv[3] : "");
+    }
+    if (argc > 2 && string(argv[1]) == "--merge-moves")
+    {
+        return ChainExport::mergeMoves(argv[2], argc > 3 ? argv[3] : "");
+    }
 
-    initializeFiles();
+    auto startTime = chrono::steady_clock::now();
+    size_t keyPoolLowWater = 8;
+    string keystorePath = Keystore::DEFAULT_PATH;
+    bool recover = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string flag = argv[i];
+        if (flag == "--recover")
+        {
+            recover = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            break;
+        }
+        if (flag == "--scheme")
+        {
+            try
+            {
+                SignatureScheme::setDefault(SignatureScheme::parse(argv[i + 1]));
+            }
+            catch (const exception &e)
+            {
+                cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        else if (flag == "--key-pool")
+        {
+            try
+            {
+                keyPoolLowWater = stoul(argv[i + 1]);
+            }
+            catch (const exception &)
+            {
+                cerr << "Error: --key-pool expects a number of keys, got '" << argv[i + 1] << "'\n";
+                return 1;
+            }
+        }
+        else if (flag == "--keystore")
+        {
+            keystorePath = argv[i + 1];
+        }
+        else if (flag == "--log-level")
+        {
+            try
+            {
+                Logger::instance().setDefaultLevel(Logger::parseLevel(argv[i + 1]));
+            }
+            catch (const exception &e)
+            {
+                cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        else if (flag == "--log-node")
+        {
+            // <nodeId>=<level>
+            string setting = argv[i + 1];
+            size_t split = setting.find('=');
+            if (split == string::npos)
+            {
+                cerr << "Error: --log-node expects <nodeId>=<level>\n";
+                return 1;
+            }
+            try
+            {
+                Logger::instance().setNodeLevel(setting.substr(0, split), Logger::parseLevel(setting.substr(split + 1)));
+            }
+            catch (const exception &e)
+            {
+                cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        else if (flag == "--durability")
+        {
+            // <class>=<none|group|sync>[,...]
+            try
+            {
+                DurableWriter::instance().configure(argv[i + 1]);
+            }
+            catch (const exception &e)
+            {
+                cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        i++; // Skip the flag's value
+    }
+
+    // Identities from earlier runs; only the players it lacks get new keys
+    Keystore keystore(keystorePath);
+    vector<KeyRecord> storedKeys;
+    try
+    {
+        storedKeys = keystore.load();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Player keys are generated in the background while the main nodes start up
+    if (keyPoolLowWater > 0 && storedKeys.size() < PLAYER_COUNT)
+    {
+        KeyPool::instance().start(SignatureScheme::defaultAlgorithm(), keyPoolLowWater);
+    }
+
+    initializeFiles(recover);
+    Logger::instance().start("./logs.jsonl");
     try
     {
+        // Main nodes keep their ids across a recovery so they find their own files
+        vector<int> nodeIds(3, 0);
+        if (recover)
+        {
+            try
+            {
+                vector<string> ids = Checkpoint::load().idsOf(CheckpointKind::MainNode);
+                for (size_t i = 0; i < ids.size() && i < nodeIds.size(); i++)
+                {
+                    nodeIds[i] = stoi(ids[i]);
+                }
+            }
+            catch (const exception &e)
+            {
+                cerr << "Error: " << e.what() << ", starting with new main nodes\n";
+            }
+        }
+
+        if (recover)
+        {
+            // Recovered blocks have their move signatures checked, so the stored players must be known first
+            for (const auto &record : storedKeys)
+            {
+                KeyCache::instance().registerKey(SignatureScheme::publicKeyPem(record.key.get()));
+            }
+        }
 
         // // Initialize blockchain and nodes
         MainChain *blk = new MainChain();
-        MainNode *node1 = new MainNode(*blk, 5);
-        MainNode *node2 = new MainNode({node1}, 5);
-        MainNode *node3 = new MainNode({node1, node2}, 5);
+        MainNode *node1 = new MainNode(*blk, nodeIds[0]);
+        MainNode *node2 = new MainNode({node1}, nodeIds[1]);
+        MainNode *node3 = new MainNode({node1, node2}, nodeIds[2]);
 
         // Ensure all nodes are interconnected
         node1->connectPeer(node2);
@@ -95,20 +329,32 @@ int main()
 
         // // Initialize blockchain and nodes
         // MainChain *blk = new MainChain();
-        // MainNode *node1 = new MainNode(*blk, 5);
-        // MainNode *node2 = new MainNode({node1}, 5);
+        // MainNode *node1 = new MainNode(*blk);
+        // MainNode *node2 = new MainNode({node1});
 
         // // Ensure all nodes are interconnected
         // node1->connectPeer(node2);
         // node2->connectPeer(node1);
 
-        // Start mining threads for all nodes
-        thread mainMiningThread1(&MainNode::mineBlock, node1);
-        thread mainMiningThread2(&MainNode::mineBlock, node2);
-        thread mainMiningThread3(&MainNode::mineBlock, node3);
-
         // Initialize players
-        Player p1(4), p2(4), p3(4), p4(4), p5(4), p6(4), p7(4), p8(4);
+        vector<unique_ptr<Player>> players;
+        for (size_t i = 0; i < PLAYER_COUNT; i++)
+        {
+            players.push_back(i < storedKeys.size() ? make_unique<Player>(storedKeys[i]) : make_unique<Player>());
+        }
+        // Every player has its key now, so the workers would only burn CPU from here on
+        KeyPool::instance().stop();
+        if (storedKeys.size() < PLAYER_COUNT)
+        {
+            vector<KeyRecord> records;
+            for (const auto &player : players)
+            {
+                records.push_back(player->keyRecord());
+            }
+            keystore.save(records);
+        }
+        Player &p1 = *players[0], &p2 = *players[1], &p3 = *players[2], &p4 = *players[3];
+        Player &p5 = *players[4], &p6 = *players[5], &p7 = *players[6], &p8 = *players[7];
         // p1.connectNode(*node1);
         // p2.connectNode(*node1);
         // p3.connectNode(*node2);
@@ -118,9 +364,13 @@ int main()
         // p7.connectNode(*node3);
         // p8.connectNode(*node3);
 
-        cout << "Players created successfully!" << endl;
+        KeyPoolStats keys = KeyPool::instance().stats();
+        cout << "Players created successfully! Keys: " << min(storedKeys.size(), PLAYER_COUNT) << " from "
+             << keystore.getPath() << ", " << keys.pooled << " from pool, " << keys.generatedInline << " generated inline" << endl;
 
-        // Create games
+        size_t resumed = recover ? resumeGames(players) : 0;
+
+        // Create games; players resuming one are skipped
         createNewGame(p1, p2);
         createNewGame(p3, p4);
         createNewGame(p5, p6);
@@ -128,6 +378,32 @@ int main()
 
         cout << "Players connected successfully, games started" << endl;
 
+        // Everything is validated at this point, so it becomes the checkpoint the next recovery trusts
+        vector<MainNode *> nodes = {node1, node2, node3};
+        writeCheckpoint(nodes, players);
+        double readyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+        RecoveryStats chainRecovery = node1->getRecoveryStats();
+        size_t queued = 0;
+        for (auto node : nodes)
+        {
+            queued += node->getRecoveryStats().queuedTransactions;
+        }
+        string ready = "Ready in " + to_string((long long)readyMs) + " ms" +
+                       (recover ? " (recovered main chain height " + to_string(blk->size()) + ": " +
+                                      to_string(chainRecovery.trustedBlocks) + " blocks trusted from checkpoint, " +
+                                      to_string(chainRecovery.verifiedBlocks) + " re-validated, " +
+                                      to_string(chainRecovery.droppedBlocks) + " dropped; ratings replayed over " +
+                                      to_string(chainRecovery.ratingReplays) + " blocks; " + to_string(queued) +
+                                      " queued games; " + to_string(resumed) + " games resumed)"
+                                : "");
+        cout << ready << endl;
+        LOG_AT(LogLevel::Info, Logger::instance().levelFor("main"), "main", ready);
+
+        // Start mining threads for all nodes
+        thread mainMiningThread1(&MainNode::mineBlock, node1);
+        thread mainMiningThread2(&MainNode::mineBlock, node2);
+        thread mainMiningThread3(&MainNode::mineBlock, node3);
+
         // Add transactions (moves)
         bool turn = false;
         for (int i = 0; i < 10; i++)
@@ -166,10 +442,28 @@ int main()
         // Allow time for mining and synchronization
         this_thread::sleep_for(chrono::seconds(30));
 
+        LoggerStats logs = Logger::instance().stats();
+        cout << "Log: " << logs.written << " entries written in " << logs.batches << " batches, "
+             << logs.dropped << " dropped" << endl;
+        DurableStats durable = DurableWriter::instance().getStats();
+        cout << "Durable writes: " << durable.commits << " commits, " << durable.fsyncs << " fsyncs, "
+             << durable.batches << " group batches" << endl;
+        SignatureCacheStats signatures = SignatureCache::instance().stats();
+        cout << "Signature cache: " << signatures.hits << " hits, " << signatures.misses << " misses, "
+             << signatures.evictions << " evictions, " << signatures.entries << " entries" << endl;
+        BatchStats batches = BatchVerifier::stats();
+        cout << "Batch verification: " << batches.batches << " batches, " << batches.signatures << " signatures checked, "
+             << (batches.batches ? batches.totalSeconds * 1000 / batches.batches : 0.0) << " ms average, "
+             << batches.maxSeconds * 1000 << " ms max" << endl;
+
         // Stop nodes
         node1->stop();
         node2->stop();
-        // node3->stop();
+        node3->stop();
+        for (const auto &player : players)
+        {
+            player->stop();
+        }
 
         // Join player mining threads
         playerMiningThread1.join();
@@ -185,6 +479,14 @@ int main()
         mainMiningThread1.join();
         mainMiningThread2.join();
         mainMiningThread3.join();
+
+        // A clean shutdown; the next --recover only re-validates what is written after this
+        writeCheckpoint(nodes, players);
+
+        MoveJournalFlusher::instance().flushAll();
+        MoveJournalStats journaled = MoveJournalFlusher::instance().stats();
+        cout << "Move journals: " << journaled.written << " of " << journaled.appended << " moves written in "
+             << journaled.flushes << " flushes" << endl;
     }
     catch (const exception &e)
     {
@@ -0,0 +1,98 @@
+// Checks that --export-mempool only reads: every mempool file a running node has open
+// must be byte-identical after the export, and the node's journal must keep working.
+#include "ChainCodec.hpp"
+#include "ChainExport.hpp"
+#include "KeyCache.hpp"
+#include "MempoolJournal.hpp"
+#include "SignatureScheme.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+using namespace std;
+using json = nlohmann::json;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+    do                                                                     \
+    {                                                                      \
+        if (!(condition))                                                  \
+        {                                                                  \
+            cerr << __FILE__ << ":" << __LINE__ << ": " #condition << endl; \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static string readFile(const string &path)
+{
+    ifstream in(path, ios::binary);
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+int main()
+{
+    char dirTemplate[] = "/tmp/mempool_export_XXXXXX";
+    string dir = mkdtemp(dirTemplate);
+    string base = dir + "/1_mempool";
+
+    const SignatureScheme &scheme = SignatureScheme::get(SignatureAlgorithm::ED25519);
+    KeyHandle sender = scheme.generateKey();
+    KeyHandle receiver = scheme.generateKey();
+    Address senderAddress = KeyCache::instance().registerKey(SignatureScheme::publicKeyPem(sender.get()));
+    Address receiverAddress = KeyCache::instance().registerKey(SignatureScheme::publicKeyPem(receiver.get()));
+    vector<Move> moves;
+    for (const char *uci : {"e2e4", "g1f3", "f1c4"})
+    {
+        Move move(senderAddress, receiverAddress, ChessMove::fromUci(uci));
+        move.signTransaction(sender.get());
+        moves.push_back(move);
+    }
+
+    {
+        // Stands in for a running node: its journal stays open through the export
+        MempoolJournal live(base);
+        for (const auto &move : moves)
+        {
+            live.add(move.digest(), ChainCodec::encodeMove(move));
+        }
+        live.remove({moves[0].digest()});
+        // A rotation a crash interrupted leaves an old journal behind
+        ofstream(base + ".journal.old", ios::binary) << readFile(base + ".journal");
+
+        map<string, string> before;
+        for (const char *suffix : {".snapshot", ".journal", ".journal.old"})
+        {
+            before[suffix] = readFile(base + suffix);
+        }
+
+        CHECK(ChainExport::exportMempool(base, dir + "/out.json") == 0);
+        for (const auto &file : before)
+        {
+            CHECK(readFile(base + file.first) == file.second);
+        }
+
+        json exported = json::parse(readFile(dir + "/out.json"));
+        CHECK(exported.size() == 2);
+        CHECK(exported.size() == 2 && exported[0]["move"] == "g1f3" && exported[1]["move"] == "f1c4");
+
+        Move extra(senderAddress, receiverAddress, ChessMove::fromUci("d2d4"));
+        extra.signTransaction(sender.get());
+        live.add(extra.digest(), ChainCodec::encodeMove(extra));
+    }
+
+    // Nothing the node journaled before or after the export was lost
+    CHECK(MempoolJournal::read(base).size() == 3);
+
+    system(("rm -rf " + dir).c_str());
+    if (failures == 0)
+    {
+        cout << "MempoolExportTest passed" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}